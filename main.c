@@ -2,795 +2,534 @@
 #include <stdlib.h>
 #include <memory.h>
 #include <time.h>
-#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "vigne.h"
 
 //////////////////////////////
 // マクロ・定数
 //////////////////////////////
-#define OBJECT_SIZE 4000
-#define SCALE_SIZE 20
+#define OBJECT_SIZE VIGNE_OBJECT_SIZE
+#define SCALE_SIZE VIGNE_SCALE_SIZE
 #define GENERATOR_FILE_NAME "generators.txt"
 #define EQUIPMENT_FILE_NAME "equipments.txt"
 #define EXPORT_FILE_PREFIX "route"
-#define ZX_WIDTH_MIN 3
-#define ZX_WIDTH_MAX 5
-#define GENERATION 30000
-#define INDEX(x,y,z) (((x) * SCALE_SIZE * SCALE_SIZE) + ((y) * SCALE_SIZE) + (z))
-#define IS_OPEN(rt)  ((rt)->prev == -1 && (rt)->next == -1)
-#define IS_CLOSE(rt) ((rt)->prev != -1 || (rt)->next != -1)
-#define IS_HEAD(rt)  ((rt)->prev == -1 && (rt)->next != -1)
-#define IS_TAIL(rt)  ((rt)->prev != -1 && (rt)->next == -1)
+#define BATCH_THREAD_MAX 64
+#define BATCH_STACK_SIZE (64 * 1024 * 1024)
+#define BATCH_PATH_SIZE 256
+#define BATCH_LINE_SIZE 1024
+#define VTK_BUFFER_SIZE (1024 * 1024)
+#define VTK_PATH_SIZE (BATCH_PATH_SIZE + 4)
 
 //////////////////////////////
 // 型定義
 //////////////////////////////
 
 typedef struct {
-  int x; // X座標
-  int y; // Y座標
-  int z; // Z座標
-} xyz_t;
+  int plot;   // gnuplot で表示するか
+  int vtk;    // 順路ファイルと一緒に VTK ファイルを出力するか
+  int box[6]; // VTK に出力する範囲（x0, y0, z0, x1, y1, z1、両端を含む）
+} output_t;
 
 typedef struct {
-  xyz_t gen; // 発電機の座標
-  xyz_t equ; // 装置の座標
-  int cost;  // 二点間のコスト
-} object_t;
+  vigne_solver_t const* solver;   // 出力する解（出力が終わるまで書き換えない）
+  char file_name[VTK_PATH_SIZE];  // 出力ファイル
+  int box[6];                     // 出力する範囲
+  pthread_t thread;               // 出力スレッド
+  int started;                    // スレッドを起動したか
+  int ret;                        // 出力の結果
+} vtk_writer_t;
 
 typedef struct {
-  int prev;    // 前のINDEX
-  int next;    // 次のINDEX
-  xyz_t coord; // 座標
-} route_t;
+  int no;                              // インスタンスNo.
+  char gen_file[BATCH_PATH_SIZE];      // 発電機の座標ファイル
+  char equ_file[BATCH_PATH_SIZE];      // 装置の座標ファイル
+  char export_file[BATCH_PATH_SIZE];   // 順路の出力ファイル
+  int total;                           // 順路数（読み込み失敗時は -1）
+  int bound;                           // 順路数の上界
+  long generation;                     // 実行した世代数
+  double elapsed;                      // 実行時間（秒）
+  int check;                           // 順路ファイルチェックの結果
+} result_t;
 
 typedef struct {
-  int key;   // KEY
-  int value; // VALUE
-} qsort_t;
+  FILE* fp;                // インスタンスを読み込むファイル（マニフェスト or 標準入力）
+  pthread_mutex_t mutex;   // fp と result_list の排他
+  uint32_t seed;           // 乱数seed（インスタンスNo.を足して使う）
+  double time_limit;       // インスタンスごとの制限時間（秒、0以下なら無制限）
+  vigne_config_t config;   // ソルバーの設定（seed はインスタンスごとに上書き）
+  output_t output;         // 出力の設定
+  int instance_size;       // 読み込んだインスタンスの数
+  int result_size;         // 結果の数
+  int result_capacity;     // 結果の確保数
+  result_t* result_list;   // 結果リスト
+} batch_t;
 
 //////////////////////////////
 // プロトタイプ宣言
 //////////////////////////////
-object_t* create_object_list();
-int dist(int const _gen_x, int const _gen_y, int const _gen_z,
-          int const _equ_x, int const _equ_y, int const _equ_z);
-int* create_object_no_list(object_t* const _object_list);
-route_t* create_route_list();
-int qsort_desc(void const* const _a, void const* const _b);
-qsort_t* create_cost_list(object_t const* const _object_list);
-void search_route(object_t const* const _object_list, int const* const _object_no_list,
-                  qsort_t const* const _cost_list, route_t* const _route_list);
-void search_route_by_object_no(object_t const* const _object_list,
-                                int const* const _object_no_list,
-                                int const _object_no, route_t* const _route_list);
-void search_route_by_kopt(object_t const* const _object_list,  
-                          int const* const _object_no_list,
-                          int const _from_x, int const _from_y, int const _from_z,
-                          int const _to_x, int const _to_y, int const _to_z,
-                          route_t* const _route_list);
-void kopt_local_search(object_t const* const _object_list,  
-                        int const* const _object_no_list,
-                        int const _from_x, int const _from_y, int const _from_z,
-                        int const _to_x, int const _to_y, int const _to_z,
-                        int const _depth, int const _total_cost,
-                        int* const _best_cost, int* const _best_route,
-                        route_t* const _route_list);
-void search_route_by_object_no_multi_way(object_t const* const _object_list,
-                                          int const* const _object_no_list,
-                                          int const _object_no, route_t* const _route_list);
-void search_route_by_kopt_multi_way(object_t const* const _object_list,  
-                                    int const* const _object_no_list,
-                                    int const _from_x, int const _from_y, int const _from_z,
-                                    int const _to_x, int const _to_y, int const _to_z,
-                                    route_t* const _route_list);
-void kopt_multi_way_local_search(object_t const* const _object_list,  
-                                  int const* const _object_no_list,
-                                  int const _from_x, int const _from_y, int const _from_z,
-                                  int const _to_x, int const _to_y, int const _to_z,
-                                  int const _depth, int const _total_cost,
-                                  int* const _best_cost, int* const _best_route,
-                                  route_t* const _route_list);
-void kopt_next_call(object_t const* const _object_list,  
-                    int const* const _object_no_list,
-                    int const _from_x, int const _from_y, int const _from_z,
-                    int const _next_x, int const _next_y, int const _next_z,
-                    int const _to_x, int const _to_y, int const _to_z,
-                    int const _depth, int const _total_cost,
-                    int* const _best_cost, int* const _best_route,
-                    route_t* const _route_list);
-void kopt_best_judge(int const _x, int const _y, int const _z,
-                      int const _total_cost, int* const _best_cost,
-                      int* const _best_route, route_t* const _route_list);
-int count_route(object_t const* const _object_list, route_t const* const _route_list);
-void plot(object_t const* const _object_list, route_t const* const _route_list);
-void export_route(object_t const* const _object_list,
-                  route_t const* const _route_list, char const* const _file_name);
-int route_file_check(int const* const _object_no_list, char const* const _file_name);
-void initrand(uint32_t seed);
-double urand();
-void zoning_remove(route_t const* const _route_parent, route_t* const _route_child);
-void zx_crossover(object_t const* const _object_list, int const* const _object_no_list, qsort_t const* const _cost_list,
-                  route_t const* const _route_parent_1, route_t const* const _route_parent_2,
-                  route_t* const _route_child_1, route_t* const _route_child_2);
-int zx_inner_zone(int const _begin_x, int const _end_x,
-                  int const _begin_y, int const _end_y,
-                  int const _begin_z, int const _end_z,
-                  int const _route_index, route_t const* const _route_list);
-void zx_remove_route(int const _route_index, route_t* const _route_list);
+int solve_single(vigne_config_t const* const _config, double const _time_limit, output_t const* const _output);
+void on_update_single(void* _user, vigne_solver_t const* _solver, int _total, int _stale);
+int solve_batch(char const* const _manifest_file, int const _thread_size,
+                vigne_config_t const* const _config, double const _time_limit, output_t const* const _output);
+void* batch_worker(void* _arg);
+int batch_next(batch_t* const _batch, result_t* const _result);
+int result_no_asc(void const* const _a, void const* const _b);
+void batch_summary(batch_t* const _batch);
+double get_time();
+int load_object_file(int* const _gen_xyz, int* const _equ_xyz,
+                     char const* const _gen_file, char const* const _equ_file);
+void plot(vigne_solver_t const* const _solver);
+void export_route(vigne_solver_t const* const _solver, char const* const _file_name);
+void vtk_start(vtk_writer_t* const _writer, vigne_solver_t const* const _solver,
+               char const* const _file_name, int const* const _box);
+int vtk_wait(vtk_writer_t* const _writer);
+void* vtk_worker(void* _arg);
+int export_vtk(vigne_solver_t const* const _solver, char const* const _file_name, int const* const _box);
+void vtk_pass(FILE* const _fp, vigne_solver_t const* const _solver, int const* const _box, int const _pass,
+              int* const _point_size, int* const _line_size);
+int route_file_check(vigne_solver_t const* const _solver, char const* const _file_name);
 
 //////////////////////////////
 // エントリーポイント
 //////////////////////////////
-int main() {
-  char export_file_name[256];
-  int i, j, r, total_parent, total_child;
-  object_t* object_list = NULL;
-  int* object_no_list = NULL;
-  route_t* route_parent = NULL;
-  route_t* route_child = NULL;
-  route_t* route_temp = NULL;
-  qsort_t* cost_list = NULL;
-  qsort_t tmp;
-
-  // ランダム関数の初期化
-  initrand((unsigned int)time(NULL));
-
-  // オブジェクト（発電機・装置）リスト生成
-  printf("create object list ... ");
-  if((object_list = create_object_list()) == NULL) {
-    return -1;
+int main(int argc, char* argv[]) {
+  char const* manifest_file = NULL;
+  vigne_config_t config;
+  output_t output;
+  int i, thread_size;
+  double time_limit;
+
+  // 引数解析
+  vigne_config_init(&config);
+  thread_size = 1;
+  time_limit = 0.0;
+  output.plot = 0;
+  output.vtk = 0;
+  output.box[0] = output.box[1] = output.box[2] = 0;
+  output.box[3] = output.box[4] = output.box[5] = SCALE_SIZE - 1;
+  for(i = 1; i < argc; ++ i) {
+    if(strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+      manifest_file = argv[++ i];
+    } else if(strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      thread_size = atoi(argv[++ i]);
+    } else if(strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      time_limit = atof(argv[++ i]);
+    } else if(strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+      config.tile_size = atoi(argv[++ i]);
+    } else if(strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      config.threads = atoi(argv[++ i]);
+    } else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      config.speculate_window = atoi(argv[++ i]);
+    } else if(strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+      config.gap_limit = atof(argv[++ i]);
+    } else if(strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+      config.conflict_length = atoi(argv[++ i]);
+    } else if(strcmp(argv[i], "-L") == 0 && i + 1 < argc) {
+      config.learn_batch = atoi(argv[++ i]);
+    } else if(strcmp(argv[i], "-G") == 0) {
+      output.plot = 1;
+    } else if(strcmp(argv[i], "-v") == 0) {
+      output.vtk = 1;
+    } else if(strcmp(argv[i], "-x") == 0 && i + 1 < argc
+           && sscanf(argv[++ i], "%d,%d,%d,%d,%d,%d", output.box, output.box + 1, output.box + 2,
+                     output.box + 3, output.box + 4, output.box + 5) == 6) {
+      output.vtk = 1;
+    } else {
+      fprintf(stderr, "usage: %s [-b manifest|-] [-j threads] [-t seconds] [-c tile] [-p threads] [-s window] [-i length] [-g gap]"
+              " [-L batch] [-G] [-v] [-x x0,y0,z0,x1,y1,z1]\n", argv[0]);
+      return -1;
+    }
   }
-  printf("ok\n");
-
-  // オブジェクトNo.リスト生成
-  printf("create object No. list ... ");
-  if((object_no_list = create_object_no_list(object_list)) == NULL) {
+  // 衝突しないペアの先行探索は並列構築の一部
+  if(config.conflict_length > 0 && config.threads <= 1) {
+    fprintf(stderr, "%s: -i requires -p with 2 or more threads\n", argv[0]);
     return -1;
   }
-  printf("ok\n");
-
-  // コストリスト生成
-  printf("create cost list ... ");
-  if((cost_list = create_cost_list(object_list)) == NULL) {
-    return -1;
+  // 単一インスタンス
+  if(manifest_file == NULL) {
+    return solve_single(&config, time_limit, &output);
   }
-  printf("ok\n");
+  // バッチ
+  return solve_batch(manifest_file, thread_size, &config, time_limit, &output);
+}
 
-  // 順路リスト生成
-  printf("create route list ... ");
-  if((route_parent = create_route_list()) == NULL) {
-    return -1;
-  }
-  if((route_child = create_route_list()) == NULL) {
+//////////////////////////////
+// 単一インスタンスの順路探索
+//////////////////////////////
+int solve_single(vigne_config_t const* const _config, double const _time_limit, output_t const* const _output) {
+  static int gen_xyz[OBJECT_SIZE * 3];
+  static int equ_xyz[OBJECT_SIZE * 3];
+  char export_file_name[256];
+  char vtk_file_name[256];
+  vigne_solver_t* solver = NULL;
+  vigne_config_t config;
+  vtk_writer_t vtk;
+  int total;
+
+  // オブジェクト（発電機・装置）リスト読み込み
+  printf("create object list ... ");
+  if(load_object_file(gen_xyz, equ_xyz, GENERATOR_FILE_NAME, EQUIPMENT_FILE_NAME) != 0) {
     return -1;
   }
   printf("ok\n");
 
-  // 順路検索
+  // ソルバー生成と順路検索
   printf("search route ... ");
-  search_route(object_list, object_no_list, cost_list, route_parent);
+  config = *_config;
+  config.on_update = on_update_single;
+  if((solver = vigne_create(gen_xyz, equ_xyz, OBJECT_SIZE, &config)) == NULL) {
+    return -1;
+  }
   printf("ok\n");
 
-  // 順路数の表示
-  total_parent = count_route(object_list, route_parent);
-  printf("total = %d\n", total_parent);
+  // 順路数と上界の表示
+  printf("total = %d, bound = %d\n", vigne_score(solver), vigne_bound(solver));
 
   // 順路探索ループ
-  for(i = 0; i < GENERATION; ++ i) {
-    // ゾーン削除
-    zoning_remove(route_parent, route_child);
-    // ランダムにシャッフル
-    for(j = 0; j < OBJECT_SIZE; ++ j) {
-      r = (int)(urand() * (double)OBJECT_SIZE);
-      tmp = cost_list[j];
-      cost_list[j] = cost_list[r];
-      cost_list[r] = tmp;
-    }
-    // コストが高い順にソート
-    qsort(cost_list, OBJECT_SIZE, sizeof(qsort_t), qsort_desc);
-    // 順路再構築
-    search_route(object_list, object_no_list, cost_list, route_child);
-    // 順路数の表示
-    total_child = count_route(object_list, route_child);
-    // 更新
-    if(total_child > total_parent) {
-      printf("update total = %d, i = %d\n", total_child, i);
-      i = -1;
-      sprintf(export_file_name, "%s_%d.txt", EXPORT_FILE_PREFIX, total_child);
-      export_route(object_list, route_child, export_file_name);
+  total = vigne_run(solver, _time_limit, 0);
 
-      total_parent = total_child;
-      route_temp = route_parent;
-      route_parent = route_child;
-      route_child = route_temp;
-    }
-  }
-  
   // 順路数の表示
-  total_parent = count_route(object_list, route_parent);
-  printf("total = %d\n", total_parent);
+  printf("total = %d\n", total);
 
   // グラフ表示
-  printf("plot ... ");
-  plot(object_list, route_parent);
-  printf("ok\n");
+  if(_output->plot) {
+    printf("plot ... ");
+    plot(solver);
+    printf("ok\n");
+  }
+
+  // VTK は裏で書き出す（解はもう書き換えないので、順路ファイルの出力・チェックと並行できる）
+  vtk.started = 0;
+  if(_output->vtk) {
+    sprintf(vtk_file_name, "%s_%d.vtk", EXPORT_FILE_PREFIX, total);
+    vtk_start(&vtk, solver, vtk_file_name, _output->box);
+  }
 
   // 順路をエクスポート
   printf("export route ... ");
-  sprintf(export_file_name, "%s_%d.txt", EXPORT_FILE_PREFIX, total_parent);
-  export_route(object_list, route_parent, export_file_name);
+  sprintf(export_file_name, "%s_%d.txt", EXPORT_FILE_PREFIX, total);
+  export_route(solver, export_file_name);
   printf("ok\n");
 
   // 順路ファイルチェック
   printf("route check %s ... ", export_file_name);
-  if(route_file_check(object_no_list, export_file_name) == 0) {
+  if(route_file_check(solver, export_file_name) == 0) {
     printf("ok\n");
   }
 
+  // VTK の書き出し待ち
+  if(_output->vtk) {
+    printf("export vtk %s ... ", vtk_file_name);
+    if(vtk_wait(&vtk) == 0) {
+      printf("ok\n");
+    }
+  }
+
   // メモリ開放
-  free(object_list);
-  free(object_no_list);
-  free(route_parent);
-  free(route_child);
-  free(cost_list);
+  vigne_destroy(solver);
   return 0;
 }
 
 //////////////////////////////
-// オブジェクト（発電機・装置）リスト生成
+// 順路数更新時の表示とエクスポート
 //////////////////////////////
-object_t* create_object_list() {
-  object_t* mem = NULL;
-  FILE* fp_gen;
-  FILE* fp_equ;
-  int i;
-  object_t* obj;
-
-  // メモリ確保
-  if((mem = (object_t*)malloc(sizeof(object_t) * OBJECT_SIZE)) == NULL) {
-    return NULL;
-  }
-  // 発電機の座標ファイル
-  if((fp_gen = fopen(GENERATOR_FILE_NAME, "r")) == NULL) {
-    free(mem);
-    return NULL;
-  }
-  // 装置の座標ファイル
-  if((fp_equ = fopen(EQUIPMENT_FILE_NAME, "r")) == NULL) {
-    free(mem);
-    fclose(fp_gen);
-    return NULL;
-  }
-  // 座標読み込み
-  for(i = 0; i < OBJECT_SIZE; ++ i) {
-    obj = mem + i;
-    fscanf(fp_gen, "%d %d %d", &(obj->gen.x), &(obj->gen.y), &(obj->gen.z));
-    fscanf(fp_equ, "%d %d %d", &(obj->equ.x), &(obj->equ.y), &(obj->equ.z));
-    // コスト
-    obj->cost = (SCALE_SIZE + SCALE_SIZE + SCALE_SIZE)
-              - dist(obj->gen.x, obj->gen.y, obj->gen.z, obj->equ.x, obj->equ.y, obj->equ.z);
-    // DEBUG
-    // printf("obj[%04d] gen: %02d %02d %02d | equ: %02d %02d %02d | cost: %d\n",
-    //        i, obj->gen.x, obj->gen.y, obj->gen.z,
-    //        obj->equ.x, obj->equ.y, obj->equ.z, obj->cost);
-  } 
-  fclose(fp_gen);
-  fclose(fp_equ);
-  return mem;
-}
+void on_update_single(void* _user, vigne_solver_t const* _solver, int _total, int _stale) {
+  char export_file_name[256];
 
-//////////////////////////////
-// 二点間の最短距離を求める
-//////////////////////////////
-int dist(int const _gen_x, int const _gen_y, int const _gen_z,
-          int const _equ_x, int const _equ_y, int const _equ_z) {
-  return abs(_gen_x - _equ_x) + abs(_gen_y - _equ_y) + abs(_gen_z - _equ_z);
+  (void)_user;
+  printf("update total = %d, bound = %d, gap = %.2f%%, i = %d\n",
+         _total, vigne_bound(_solver), 100.0 * (double)(vigne_bound(_solver) - _total) / (double)vigne_bound(_solver), _stale);
+  sprintf(export_file_name, "%s_%d.txt", EXPORT_FILE_PREFIX, _total);
+  export_route(_solver, export_file_name);
 }
 
 //////////////////////////////
-// オブジェクトNo.リスト生成
+// バッチ順路探索
 //////////////////////////////
-int* create_object_no_list(object_t* const _object_list) {
-  int* mem = NULL;
-  int i;
-  object_t* obj;
-  // DEBUG
-  // int x, y, z;
+int solve_batch(char const* const _manifest_file, int const _thread_size,
+                vigne_config_t const* const _config, double const _time_limit, output_t const* const _output) {
+  pthread_t thread_list[BATCH_THREAD_MAX];
+  pthread_attr_t attr;
+  batch_t batch;
+  int i, thread_size;
 
-  // メモリ確保
-  if((mem = (int*)malloc(sizeof(int) * SCALE_SIZE * SCALE_SIZE * SCALE_SIZE)) == NULL) {
-    return NULL;
+  // マニフェストを開く（"-" なら標準入力から読み込む）
+  if(strcmp(_manifest_file, "-") == 0) {
+    batch.fp = stdin;
+  } else if((batch.fp = fopen(_manifest_file, "r")) == NULL) {
+    return -1;
   }
-  // No.紐付け
-  for(i = 0; i < OBJECT_SIZE; ++ i) {
-    obj = _object_list + i;
-    mem[INDEX(obj->gen.x, obj->gen.y, obj->gen.z)] = i;
-    mem[INDEX(obj->equ.x, obj->equ.y, obj->equ.z)] = i;
+  pthread_mutex_init(&batch.mutex, NULL);
+  batch.seed = (uint32_t)time(NULL);
+  batch.time_limit = _time_limit;
+  batch.config = *_config;
+  batch.output = *_output;
+  batch.instance_size = 0;
+  batch.result_size = 0;
+  batch.result_capacity = 0;
+  batch.result_list = NULL;
+
+  // スレッド数
+  thread_size = _thread_size;
+  if(thread_size < 1) {
+    thread_size = 1;
+  } else if(thread_size > BATCH_THREAD_MAX) {
+    thread_size = BATCH_THREAD_MAX;
+  }
+  // ワーカー起動（全方向探索の再帰が深くなるのでスタックを広げる）
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, BATCH_STACK_SIZE);
+  for(i = 0; i < thread_size; ++ i) {
+    if(pthread_create(&thread_list[i], &attr, batch_worker, &batch) != 0) {
+      break;
+    }
+  }
+  thread_size = i;
+  pthread_attr_destroy(&attr);
+  // ワーカー終了待ち
+  for(i = 0; i < thread_size; ++ i) {
+    pthread_join(thread_list[i], NULL);
   }
-  // DEBUG
-  // for(x = 0; x < SCALE_SIZE; ++ x) {
-  //   for(y = 0; y < SCALE_SIZE; ++ y) {
-  //     for(z = 0; z < SCALE_SIZE; ++ z) {
-  //       printf("[%02d][%02d][%02d] = %d\n", x, y, z, mem[INDEX(x, y, z)]);
-  //     }
-  //   }
-  // }
-  return mem;
-}
-
-//////////////////////////////
-// ソート用比較関数
-//////////////////////////////
-int qsort_desc(void const* const _a, void const* const _b) {
-  qsort_t const* const a = (qsort_t const*)_a;
-  qsort_t const* const b = (qsort_t const*)_b;
-  return b->value - a->value;
-}
 
-//////////////////////////////
-// コストリスト生成
-//////////////////////////////
-qsort_t* create_cost_list(object_t const* const _object_list) {
-  int i, r;
-  qsort_t* mem = NULL;
-  qsort_t* qs;
-  qsort_t tmp;
+  // 集計表
+  batch_summary(&batch);
 
-  // ソート用配列生成
-  if((mem = (qsort_t*)malloc(sizeof(qsort_t) * OBJECT_SIZE)) == NULL) {
-    return NULL;
+  // 後片付け
+  if(batch.fp != stdin) {
+    fclose(batch.fp);
   }
-  // key と value をセット
-  for(i = 0; i < OBJECT_SIZE; ++ i) {
-    qs = mem + i;
-    qs->key = i;
-    qs->value = _object_list[i].cost;
-  }
-  // ランダムにシャッフル
-  for(i = 0; i < OBJECT_SIZE; ++ i) {
-    r = (int)(urand() * (double)OBJECT_SIZE);
-    tmp = mem[i];
-    mem[i] = mem[r];
-    mem[r] = tmp;
-  }
-  // コストが高い順にソート
-  qsort(mem, OBJECT_SIZE, sizeof(qsort_t), qsort_desc);
-  return mem;
+  pthread_mutex_destroy(&batch.mutex);
+  free(batch.result_list);
+  return thread_size > 0 ? 0 : -1;
 }
 
 //////////////////////////////
-// 順路リスト生成
-//////////////////////////////
-route_t* create_route_list() {
-  int x, y, z;
-  route_t* mem = NULL;
-  route_t* rt;
-
-  // メモリ確保
-  if((mem = (route_t*)malloc(sizeof(route_t) * SCALE_SIZE * SCALE_SIZE * SCALE_SIZE)) == NULL) {
+// バッチのワーカースレッド
+//////////////////////////////
+void* batch_worker(void* _arg) {
+  batch_t* const batch = (batch_t*)_arg;
+  vigne_solver_t* solver = NULL;
+  vigne_config_t config;
+  result_t* mem = NULL;
+  result_t result;
+  vtk_writer_t vtk;
+  char vtk_file_name[VTK_PATH_SIZE];
+  int* gen_xyz = NULL;
+  int* equ_xyz = NULL;
+  int capacity, loaded;
+  double begin_time, time_limit;
+
+  // 座標配列とソルバーはスレッドごとに1つだけ確保して、インスタンス間で使い回す
+  gen_xyz = (int*)malloc(sizeof(int) * OBJECT_SIZE * 3);
+  equ_xyz = (int*)malloc(sizeof(int) * OBJECT_SIZE * 3);
+  if(gen_xyz == NULL || equ_xyz == NULL) {
+    free(gen_xyz);
+    free(equ_xyz);
     return NULL;
   }
-  // 初期化
-  for(x = 0; x < SCALE_SIZE; ++ x) {
-    for(y = 0; y < SCALE_SIZE; ++ y) {
-      for(z = 0; z < SCALE_SIZE; ++ z) {
-        rt = mem + INDEX(x, y, z);
-        rt->prev = -1;
-        rt->next = -1;
-        rt->coord.x = x;
-        rt->coord.y = y;
-        rt->coord.z = z;
+  config = batch->config;
+  while(batch_next(batch, &result) == 0) {
+    begin_time = get_time();
+    // インスタンスごとに乱数を初期化（実行順に依存しないようにする）
+    config.seed = batch->seed + (uint32_t)result.no;
+    // 読み込みと初期順路の構築
+    loaded = 0;
+    if(load_object_file(gen_xyz, equ_xyz, result.gen_file, result.equ_file) == 0) {
+      if(solver == NULL) {
+        solver = vigne_create(gen_xyz, equ_xyz, OBJECT_SIZE, &config);
+        loaded = solver != NULL;
+      } else {
+        loaded = vigne_load(solver, gen_xyz, equ_xyz, OBJECT_SIZE, &config) == 0;
       }
     }
-  }
-  return mem;
-}
-
-//////////////////////////////
-// 順路探索
-//////////////////////////////
-void search_route(object_t const* const _object_list, int const* const _object_no_list,
-                  qsort_t const* const _cost_list, route_t* const _route_list) {
-  int i;
-  object_t const* obj;
-  qsort_t const* cost;
-  route_t* rt_gen;
-  route_t* rt_equ;
-
-  // 順番に探索（局所）
-  for(i = 0; i < OBJECT_SIZE; ++ i) {
-    cost = _cost_list + i;
-    obj = _object_list + cost->key;
-    rt_gen = _route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
-    rt_equ = _route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
-    // 単方向探索
-    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
-      search_route_by_object_no(_object_list, _object_no_list, cost->key, _route_list);      
+    // 順路探索（初期順路の構築にかかった時間も制限時間に含める）
+    if(loaded) {
+      time_limit = batch->time_limit;
+      if(time_limit > 0.0) {
+        time_limit -= get_time() - begin_time;
+        if(time_limit < 1e-9) {
+          time_limit = 1e-9;
+        }
+      }
+      result.total = vigne_run(solver, time_limit, 0);
+      result.generation = vigne_generation(solver);
+      result.bound = vigne_bound(solver);
+      vtk.started = 0;
+      if(batch->output.vtk) {
+        sprintf(vtk_file_name, "%s.vtk", result.export_file);
+        vtk_start(&vtk, solver, vtk_file_name, batch->output.box);
+      }
+      export_route(solver, result.export_file);
+      result.check = route_file_check(solver, result.export_file);
+      if(batch->output.vtk && vtk_wait(&vtk) != 0) {
+        fprintf(stderr, "[%04d] export vtk %s failed\n", result.no, vtk_file_name);
+      }
     }
-    // 全方向探索
-    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
-      search_route_by_object_no_multi_way(_object_list, _object_no_list, cost->key, _route_list);      
+    result.elapsed = get_time() - begin_time;
+    printf("[%04d] %s %s ... total = %d\n",
+           result.no, result.gen_file, result.equ_file, result.total);
+    // 結果を登録
+    pthread_mutex_lock(&batch->mutex);
+    if(batch->result_size == batch->result_capacity) {
+      capacity = batch->result_capacity > 0 ? batch->result_capacity * 2 : 16;
+      if((mem = (result_t*)realloc(batch->result_list, sizeof(result_t) * capacity)) != NULL) {
+        batch->result_list = mem;
+        batch->result_capacity = capacity;
+      }
     }
-  }
-}
-
-//////////////////////////////
-// オブジェクトNo.を指定して順路探索
-//////////////////////////////
-void search_route_by_object_no(object_t const* const _object_list,
-                                int const* const _object_no_list,
-                                int const _object_no, route_t* const _route_list) {
-  object_t const* obj;
-
-  // 発電機と装置をつなぐ順路探索
-  obj = _object_list + _object_no;
-  search_route_by_kopt(_object_list, _object_no_list,
-                        obj->gen.x, obj->gen.y, obj->gen.z,
-                        obj->equ.x, obj->equ.y, obj->equ.z,
-                        _route_list);
-}
-
-//////////////////////////////
-// K-OPT 順路探索
-//////////////////////////////
-void search_route_by_kopt(object_t const* const _object_list,  
-                          int const* const _object_no_list,
-                          int const _from_x, int const _from_y, int const _from_z,
-                          int const _to_x, int const _to_y, int const _to_z,
-                          route_t* const _route_list) {
-  int best_route[SCALE_SIZE + SCALE_SIZE + SCALE_SIZE];
-  int best_cost;
-  int* index_curr;
-  int* index_prev;
-  route_t* rt_curr;
-  route_t* rt_prev;
-  
-  // 順路探索
-  best_cost = INT_MAX;
-  kopt_local_search(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _to_x, _to_y, _to_z,
-                    1, 0, &best_cost,
-                    best_route, _route_list);
-  // 順路が見つかった場合
-  if(best_cost < INT_MAX) {
-    // 順路を逆から構築
-    index_curr = best_route;
-    index_prev = best_route + 1;
-    while(*index_prev != -1) {
-      rt_curr = _route_list + *index_curr;
-      rt_prev = _route_list + *index_prev;
-      rt_curr->prev = *index_prev;
-      rt_prev->next = *index_curr;
-      ++ index_curr;
-      ++ index_prev;
+    if(batch->result_size < batch->result_capacity) {
+      batch->result_list[batch->result_size] = result;
+      ++ batch->result_size;
     }
+    pthread_mutex_unlock(&batch->mutex);
   }
+  vigne_destroy(solver);
+  free(gen_xyz);
+  free(equ_xyz);
+  return NULL;
 }
 
 //////////////////////////////
-// K-OPT 局所的な順路探索
+// 次のインスタンスを読み込む
 //////////////////////////////
-void kopt_local_search(object_t const* const _object_list,  
-                        int const* const _object_no_list,
-                        int const _from_x, int const _from_y, int const _from_z,
-                        int const _to_x, int const _to_y, int const _to_z,
-                        int const _depth, int const _total_cost,
-                        int* const _best_cost, int* const _best_route,
-                        route_t* const _route_list) {
-  int delta_x, delta_y, delta_z;
- 
-  // 順路が目的地点に到達した場合、記録判定と更新
-  if(_from_x == _to_x && _from_y == _to_y && _from_z == _to_z) {
-    kopt_best_judge(_from_x, _from_y, _from_z, _total_cost,
-                    _best_cost, _best_route, _route_list);
-    return;
-  }
-  // Z移動（プラス方向）
-  delta_z = _to_z - _from_z;
-  if(delta_z > 0) {
-    kopt_next_call(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _from_x, _from_y, _from_z + 1,
-                    _to_x, _to_y, _to_z,
-                    _depth, _total_cost, _best_cost,
-                    _best_route, _route_list);
-  }
-  // Z移動（マイナス方向）
-  else if(delta_z < 0) {
-    kopt_next_call(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _from_x, _from_y, _from_z - 1,
-                    _to_x, _to_y, _to_z,
-                    _depth, _total_cost, _best_cost,
-                    _best_route, _route_list);
-  }
+int batch_next(batch_t* const _batch, result_t* const _result) {
+  char line[BATCH_LINE_SIZE];
+  int count, ret;
 
-  // Y移動（プラス方向）
-  delta_y = _to_y - _from_y;
-  if(delta_y > 0) {
-    kopt_next_call(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _from_x, _from_y + 1, _from_z,
-                    _to_x, _to_y, _to_z,
-                    _depth, _total_cost, _best_cost,
-                    _best_route, _route_list);
-  }
-  // Y移動（マイナス方向）
-  else if(delta_y < 0) {
-    kopt_next_call(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _from_x, _from_y - 1, _from_z,
-                    _to_x, _to_y, _to_z,
-                    _depth, _total_cost, _best_cost,
-                    _best_route, _route_list);
-  }
-
-  // X移動（プラス方向）
-  delta_x = _to_x - _from_x;
-  if(delta_x > 0) {
-    kopt_next_call(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _from_x + 1, _from_y, _from_z,
-                    _to_x, _to_y, _to_z,
-                    _depth, _total_cost, _best_cost,
-                    _best_route, _route_list);
-  }
-  // X移動（マイナス方向）
-  else if(delta_x < 0) {
-    kopt_next_call(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _from_x - 1, _from_y, _from_z,
-                    _to_x, _to_y, _to_z,
-                    _depth, _total_cost, _best_cost,
-                    _best_route, _route_list);
-  }
+  // 1行に「発電機ファイル 装置ファイル [出力ファイル]」、空行と # 行は読み飛ばす
+  ret = -1;
+  memset(_result, 0, sizeof(result_t));
+  pthread_mutex_lock(&_batch->mutex);
+  while(fgets(line, sizeof(line), _batch->fp) != NULL) {
+    count = sscanf(line, "%255s %255s %255s",
+                   _result->gen_file, _result->equ_file, _result->export_file);
+    if(count <= 0 || _result->gen_file[0] == '#') {
+      continue;
+    }
+    _result->no = _batch->instance_size;
+    ++ _batch->instance_size;
+    if(count < 3) {
+      sprintf(_result->export_file, "%s_%04d.txt", EXPORT_FILE_PREFIX, _result->no);
+    }
+    ret = 0;
+    break;
+  }
+  pthread_mutex_unlock(&_batch->mutex);
+  _result->total = -1;
+  _result->bound = -1;
+  _result->check = -1;
+  return ret;
 }
 
 //////////////////////////////
-// オブジェクトNo.を指定して順路探索（全方向）
+// ソート用比較関数（インスタンスNo.昇順）
 //////////////////////////////
-void search_route_by_object_no_multi_way(object_t const* const _object_list,
-                                          int const* const _object_no_list,
-                                          int const _object_no, route_t* const _route_list) {
-  object_t const* obj;
-
-  // 発電機と装置をつなぐ順路探索
-  obj = _object_list + _object_no;
-  search_route_by_kopt_multi_way(_object_list, _object_no_list,
-                                  obj->gen.x, obj->gen.y, obj->gen.z,
-                                  obj->equ.x, obj->equ.y, obj->equ.z,
-                                  _route_list);
+int result_no_asc(void const* const _a, void const* const _b) {
+  result_t const* const a = (result_t const*)_a;
+  result_t const* const b = (result_t const*)_b;
+  return a->no - b->no;
 }
 
 //////////////////////////////
-// K-OPT 順路探索
-//////////////////////////////
-void search_route_by_kopt_multi_way(object_t const* const _object_list,  
-                                    int const* const _object_no_list,
-                                    int const _from_x, int const _from_y, int const _from_z,
-                                    int const _to_x, int const _to_y, int const _to_z,
-                                    route_t* const _route_list) {
-  int best_route[SCALE_SIZE + SCALE_SIZE + SCALE_SIZE];
-  int best_cost;
-  int* index_curr;
-  int* index_prev;
-  route_t* rt_curr;
-  route_t* rt_prev;
-
-  // 順路探索
-  best_cost = INT_MAX;
-  kopt_multi_way_local_search(_object_list, _object_no_list,
-                              _from_x, _from_y, _from_z,
-                              _to_x, _to_y, _to_z,
-                              1, 0, &best_cost,
-                              best_route, _route_list);
-  // 順路が見つかった場合
-  if(best_cost < INT_MAX) {
-    // 順路を逆から構築
-    index_curr = best_route;
-    index_prev = best_route + 1;
-    while(*index_prev != -1) {
-      rt_curr = _route_list + *index_curr;
-      rt_prev = _route_list + *index_prev;
-      rt_curr->prev = *index_prev;
-      rt_prev->next = *index_curr;
-      ++ index_curr;
-      ++ index_prev;
+// バッチの集計表を表示
+//////////////////////////////
+void batch_summary(batch_t* const _batch) {
+  int i, solved, total;
+  double elapsed;
+  result_t const* result;
+
+  qsort(_batch->result_list, _batch->result_size, sizeof(result_t), result_no_asc);
+  printf("%-6s %-7s %-7s %-8s %-9s %-6s %s\n", "no", "total", "bound", "gen", "time[s]", "check", "output");
+  solved = 0;
+  total = 0;
+  elapsed = 0.0;
+  for(i = 0; i < _batch->result_size; ++ i) {
+    result = _batch->result_list + i;
+    printf("%04d   %-7d %-7d %-8ld %-9.2f %-6s %s\n",
+           result->no, result->total, result->bound, result->generation, result->elapsed,
+           result->check == 0 ? "ok" : "ng", result->export_file);
+    if(result->total >= 0) {
+      ++ solved;
+      total += result->total;
+      elapsed += result->elapsed;
     }
   }
+  printf("instances = %d, solved = %d, total = %d, time = %.2f\n",
+         _batch->result_size, solved, total, elapsed);
 }
 
 //////////////////////////////
-// K-OPT 局所的な順路探索（全方向）
+// 経過時間計測用の時刻（秒）
 //////////////////////////////
-void kopt_multi_way_local_search(object_t const* const _object_list,  
-                                  int const* const _object_no_list,
-                                  int const _from_x, int const _from_y, int const _from_z,
-                                  int const _to_x, int const _to_y, int const _to_z,
-                                  int const _depth, int const _total_cost,
-                                  int* const _best_cost, int* const _best_route,
-                                  route_t* const _route_list) {
-  // 順路が目的地点に到達した場合、記録更新
-  if(_from_x == _to_x && _from_y == _to_y && _from_z == _to_z) {
-    kopt_best_judge(_from_x, _from_y, _from_z, _total_cost,
-                    _best_cost, _best_route, _route_list);
-    return;
-  }
-  // Z移動（プラス方向）
-  if(_from_z + 1 < SCALE_SIZE) {
-    kopt_next_call(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _from_x, _from_y, _from_z + 1,
-                    _to_x, _to_y, _to_z,
-                    _depth, _total_cost, _best_cost,
-                    _best_route, _route_list);
-  }
-  // Z移動（マイナス方向）
-  if(_from_z - 1 >= 0) {
-    kopt_next_call(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _from_x, _from_y, _from_z - 1,
-                    _to_x, _to_y, _to_z,
-                    _depth, _total_cost, _best_cost,
-                    _best_route, _route_list);
-  }
-
-  // Y移動（プラス方向）
-  if(_from_y + 1 < SCALE_SIZE) {
-    kopt_next_call(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _from_x, _from_y + 1, _from_z,
-                    _to_x, _to_y, _to_z,
-                    _depth, _total_cost, _best_cost,
-                    _best_route, _route_list);
-  }
-  // Y移動（マイナス方向）
-  if(_from_y - 1 >= 0) {
-    kopt_next_call(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _from_x, _from_y - 1, _from_z,
-                    _to_x, _to_y, _to_z,
-                    _depth, _total_cost, _best_cost,
-                    _best_route, _route_list);
-  }
+double get_time() {
+  struct timespec ts;
 
-  // X移動（プラス方向）
-  if(_from_x + 1 < SCALE_SIZE) {
-    kopt_next_call(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _from_x + 1, _from_y, _from_z,
-                    _to_x, _to_y, _to_z,
-                    _depth, _total_cost, _best_cost,
-                    _best_route, _route_list);
-  }
-  // X移動（マイナス方向）
-  if(_from_x - 1 >= 0) {
-    kopt_next_call(_object_list, _object_no_list,
-                    _from_x, _from_y, _from_z,
-                    _from_x - 1, _from_y, _from_z,
-                    _to_x, _to_y, _to_z,
-                    _depth, _total_cost, _best_cost,
-                    _best_route, _route_list);
-  }
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
 }
 
 //////////////////////////////
-// K-OPT 次の順路探索
+// 座標ファイル読み込み
 //////////////////////////////
-void kopt_next_call(object_t const* const _object_list,  
-                    int const* const _object_no_list,
-                    int const _from_x, int const _from_y, int const _from_z,
-                    int const _next_x, int const _next_y, int const _next_z,
-                    int const _to_x, int const _to_y, int const _to_z,
-                    int const _depth, int const _total_cost,
-                    int* const _best_cost, int* const _best_route,
-                    route_t* const _route_list) {
-  int index_from, index_next, object_no, cost;
-  route_t* rt_from;
-  route_t* rt_next;
-  route_t* rt_gen;
-  route_t* rt_equ;
-  object_t const* obj;
+int load_object_file(int* const _gen_xyz, int* const _equ_xyz,
+                     char const* const _gen_file, char const* const _equ_file) {
+  FILE* fp_gen;
+  FILE* fp_equ;
+  int i, ret;
 
-  // 次の順路が到達可能なら次を探す
-  index_next = INDEX(_next_x, _next_y, _next_z);
-  rt_next = _route_list + index_next;
-  if(IS_OPEN(rt_next)) {
-    // 既に順路構築不可能な座標の場合は、優先順位を上げる
-    object_no = _object_no_list[index_next];
-    obj = _object_list + object_no;
-    rt_gen = _route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
-    rt_equ = _route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
-    // 次の座標がまだ有効かどうか
-    cost = 0;
-    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
-      cost += obj->cost;
-    }
-    // 順路の紐付け
-    index_from = INDEX(_from_x, _from_y, _from_z);
-    rt_from = _route_list + index_from;
-    rt_from->next = index_next;
-    rt_next->prev = index_from;
-    // 次の順路探索
-    kopt_local_search(_object_list, _object_no_list,
-                      _next_x, _next_y, _next_z,
-                      _to_x, _to_y, _to_z,
-                      _depth + 1, _total_cost + cost,
-                      _best_cost, _best_route, _route_list);
-    // 順路の紐付け削除
-    rt_from->next = -1;
-    rt_next->prev = -1;
+  // 発電機の座標ファイル
+  if((fp_gen = fopen(_gen_file, "r")) == NULL) {
+    return -1;
   }
-}
-
-//////////////////////////////
-// K-OPT 記録判定と更新
-//////////////////////////////
-void kopt_best_judge(int const _x, int const _y, int const _z,
-                      int const _total_cost, int* const _best_cost,
-                      int* const _best_route, route_t* const _route_list) {
-  int i, index;
-
-  // 最低コストが見つかった場合は、記録更新
-  if(_total_cost < *_best_cost) {
-    *_best_cost = _total_cost;
-    i = 0;
-    index = INDEX(_x, _y, _z);
-    while (index != -1) {
-      _best_route[i] = index;
-      ++ i;
-      index = (_route_list + index)->prev;
-    }
-    _best_route[i] = -1;
+  // 装置の座標ファイル
+  if((fp_equ = fopen(_equ_file, "r")) == NULL) {
+    fclose(fp_gen);
+    return -2;
   }
-}
-
-//////////////////////////////
-// 順路の数を取得
-//////////////////////////////
-int count_route(object_t const* const _object_list, route_t const* const _route_list) {
-  int i, count;
-  object_t const* obj;
-  route_t const* rt;
-
-  count = 0;
+  // 座標読み込み
+  ret = 0;
   for(i = 0; i < OBJECT_SIZE; ++ i) {
-    obj = _object_list + i;
-    rt = _route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z);;
-    if(IS_HEAD(rt)) {
-      ++ count;
+    if(fscanf(fp_gen, "%d %d %d", _gen_xyz + i * 3, _gen_xyz + i * 3 + 1, _gen_xyz + i * 3 + 2) != 3
+    || fscanf(fp_equ, "%d %d %d", _equ_xyz + i * 3, _equ_xyz + i * 3 + 1, _equ_xyz + i * 3 + 2) != 3) {
+      ret = -3;
+      break;
     }
   }
-  return count;
+  fclose(fp_gen);
+  fclose(fp_equ);
+  return ret;
 }
 
 //////////////////////////////
 // グラフ出力
 //////////////////////////////
-void plot(object_t const* const _object_list, route_t const* const _route_list) {
+void plot(vigne_solver_t const* const _solver) {
   FILE* gp;
   int i, route_index;
-  object_t const* obj;
-  route_t const* rt;
+  vigne_cell_t const* grid;
+  vigne_cell_t const* rt;
 
-  gp = popen("gnuplot -persist","w");
+  // gnuplot が無ければ何もしない
+  if((gp = popen("gnuplot -persist","w")) == NULL) {
+    return;
+  }
   fprintf(gp, "set xrange [-1:20]\n");
   fprintf(gp, "set yrange [-1:20]\n");
   fprintf(gp, "set zrange [-1:20]\n");
   fprintf(gp, "set ticslevel 0\n");
   fprintf(gp, "splot '-' with lines linetype 1 title \"route\"\n");
 
+  grid = vigne_grid(_solver);
   for(i = 0; i < OBJECT_SIZE; ++ i) {
-    obj = _object_list + i;
-    route_index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
-    rt = _route_list + route_index;
-    if(IS_HEAD(rt)) {
-      while (route_index != -1) {
-        rt = _route_list + route_index;
-        fprintf(gp, "%d\t%d\t%d\n", rt->coord.x, rt->coord.y, rt->coord.z);
-        route_index = rt->next;
-      }
+    route_index = vigne_route_head(_solver, i);
+    while (route_index != -1) {
+      rt = grid + route_index;
+      fprintf(gp, "%d\t%d\t%d\n", rt->coord.x, rt->coord.y, rt->coord.z);
+      route_index = rt->next;
+    }
+    if(vigne_route_head(_solver, i) != -1) {
       fprintf(gp,"\n");
     }
   }
@@ -802,39 +541,35 @@ void plot(object_t const* const _object_list, route_t const* const _route_list)
 //////////////////////////////
 // 順路をエクスポート
 //////////////////////////////
-void export_route(object_t const* const _object_list,
-                  route_t const* const _route_list, char const* const _file_name) {
+void export_route(vigne_solver_t const* const _solver, char const* const _file_name) {
   FILE* fp = NULL;
-  int i, total, length, route_index;
-  object_t const* obj;
-  route_t const* rt;
+  int i, length, route_index;
+  vigne_cell_t const* grid;
+  vigne_cell_t const* rt;
 
   // ファイルを開く
   if((fp = fopen(_file_name, "w")) == NULL) {
     return;
   }
-  // 順路の数を取得
-  total = count_route(_object_list, _route_list);
   // 順路数を書き込み
-  fprintf(fp, "%d\n", total);
-  // 順路内容を書き込み
+  fprintf(fp, "%d\n", vigne_score(_solver));
+  // 順路内容を書き込み（内部グリッドを直接辿る）
+  grid = vigne_grid(_solver);
   for(i = 0; i < OBJECT_SIZE; ++ i) {
-    obj = _object_list + i;
-    route_index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
-    rt = _route_list + route_index;
-    if(IS_HEAD(rt)) {
+    route_index = vigne_route_head(_solver, i);
+    if(route_index != -1) {
       // 順路長を書き込み
       length = 0;
       while (route_index != -1) {
         ++ length;
-        rt = _route_list + route_index;
+        rt = grid + route_index;
         route_index = rt->next;
       }
       fprintf(fp, "%d\n", length);
       // 順路座標を書き込み
-      route_index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+      route_index = vigne_route_head(_solver, i);
       while (route_index != -1) {
-        rt = _route_list + route_index;
+        rt = grid + route_index;
         fprintf(fp, "%d %d %d\n", rt->coord.x, rt->coord.y, rt->coord.z);
         route_index = rt->next;
       }
@@ -844,18 +579,147 @@ void export_route(object_t const* const _object_list,
   fclose(fp);
 }
 
+//////////////////////////////
+// VTK の書き出しを裏のスレッドで始める（起動できなければその場で書き出す）
+// ファイル名が長すぎる場合は、別の名前で書き出さずに失敗にする
+//////////////////////////////
+void vtk_start(vtk_writer_t* const _writer, vigne_solver_t const* const _solver,
+               char const* const _file_name, int const* const _box) {
+  _writer->solver = _solver;
+  _writer->ret = -1;
+  _writer->started = 0;
+  if(snprintf(_writer->file_name, sizeof(_writer->file_name), "%s", _file_name) >= (int)sizeof(_writer->file_name)) {
+    return;
+  }
+  memcpy(_writer->box, _box, sizeof(_writer->box));
+  _writer->started = pthread_create(&_writer->thread, NULL, vtk_worker, _writer) == 0;
+  if(!_writer->started) {
+    _writer->ret = export_vtk(_solver, _writer->file_name, _writer->box);
+  }
+}
+
+//////////////////////////////
+// VTK の書き出し終了待ち（結果を返す）
+//////////////////////////////
+int vtk_wait(vtk_writer_t* const _writer) {
+  if(_writer->started) {
+    pthread_join(_writer->thread, NULL);
+    _writer->started = 0;
+  }
+  return _writer->ret;
+}
+
+//////////////////////////////
+// VTK の書き出しスレッド
+//////////////////////////////
+void* vtk_worker(void* _arg) {
+  vtk_writer_t* const writer = (vtk_writer_t*)_arg;
+
+  writer->ret = export_vtk(writer->solver, writer->file_name, writer->box);
+  return NULL;
+}
+
+//////////////////////////////
+// 順路を VTK（折れ線）で書き出す
+// 範囲内の部屋が続く区間ごとに1本の折れ線にし、グリッドを3回辿るので、順路を溜め込まない
+//////////////////////////////
+int export_vtk(vigne_solver_t const* const _solver, char const* const _file_name, int const* const _box) {
+  FILE* fp = NULL;
+  char* buffer = NULL;
+  int point_size, line_size;
+
+  if((fp = fopen(_file_name, "w")) == NULL) {
+    return -1;
+  }
+  // 書き込みはまとめて行う
+  if((buffer = (char*)malloc(VTK_BUFFER_SIZE)) != NULL) {
+    setvbuf(fp, buffer, _IOFBF, VTK_BUFFER_SIZE);
+  }
+  // 点と折れ線の数を数える
+  vtk_pass(NULL, _solver, _box, 0, &point_size, &line_size);
+  fprintf(fp, "# vtk DataFile Version 3.0\n");
+  fprintf(fp, "vigne route %d\n", vigne_score(_solver));
+  fprintf(fp, "ASCII\n");
+  fprintf(fp, "DATASET POLYDATA\n");
+  // 点
+  fprintf(fp, "POINTS %d int\n", point_size);
+  vtk_pass(fp, _solver, _box, 1, &point_size, &line_size);
+  // 折れ線（点の数、点の番号...）
+  fprintf(fp, "LINES %d %d\n", line_size, point_size + line_size);
+  vtk_pass(fp, _solver, _box, 2, &point_size, &line_size);
+  fclose(fp);
+  free(buffer);
+  return 0;
+}
+
+//////////////////////////////
+// 範囲内の区間を辿る（0: 数える、1: 点を書く、2: 折れ線を書く）
+//////////////////////////////
+void vtk_pass(FILE* const _fp, vigne_solver_t const* const _solver, int const* const _box, int const _pass,
+              int* const _point_size, int* const _line_size) {
+  int i, j, length, route_index, segment_index, point_no;
+  vigne_cell_t const* grid;
+  vigne_cell_t const* rt;
+
+  grid = vigne_grid(_solver);
+  point_no = 0;
+  *_line_size = 0;
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    route_index = vigne_route_head(_solver, i);
+    while(route_index != -1) {
+      // 範囲外の部屋を読み飛ばす
+      rt = grid + route_index;
+      if(rt->coord.x < _box[0] || _box[3] < rt->coord.x || rt->coord.y < _box[1] || _box[4] < rt->coord.y
+      || rt->coord.z < _box[2] || _box[5] < rt->coord.z) {
+        route_index = rt->next;
+        continue;
+      }
+      // 範囲内の部屋が続く区間の長さ
+      segment_index = route_index;
+      for(length = 0; route_index != -1; ++ length) {
+        rt = grid + route_index;
+        if(rt->coord.x < _box[0] || _box[3] < rt->coord.x || rt->coord.y < _box[1] || _box[4] < rt->coord.y
+        || rt->coord.z < _box[2] || _box[5] < rt->coord.z) {
+          break;
+        }
+        route_index = rt->next;
+      }
+      // 1部屋だけの区間は線にならないので出力しない
+      if(length < 2) {
+        continue;
+      }
+      if(_pass == 1) {
+        for(j = 0; j < length; ++ j) {
+          rt = grid + segment_index;
+          fprintf(_fp, "%d %d %d\n", rt->coord.x, rt->coord.y, rt->coord.z);
+          segment_index = rt->next;
+        }
+      } else if(_pass == 2) {
+        fprintf(_fp, "%d", length);
+        for(j = 0; j < length; ++ j) {
+          fprintf(_fp, " %d", point_no + j);
+        }
+        fprintf(_fp, "\n");
+      }
+      point_no += length;
+      ++ *_line_size;
+    }
+  }
+  *_point_size = point_no;
+}
+
 //////////////////////////////
 // 順路ファイルの整合チェック
 //////////////////////////////
-int route_file_check(int const* const _object_no_list, char const* const _file_name) {
+int route_file_check(vigne_solver_t const* const _solver, char const* const _file_name) {
   FILE* fp = NULL;
   int* mem = NULL;
-  int alloc_size, total, length;
+  int alloc_size, total, length, ret;
   int i, j, x, y, z;
   int gen_x, gen_y, gen_z, equ_x, equ_y, equ_z;
 
   // メモリ確保
-  alloc_size = sizeof(int) * SCALE_SIZE * SCALE_SIZE * SCALE_SIZE;
+  alloc_size = sizeof(int) * VIGNE_CELL_SIZE;
   if((mem = (int*)malloc(alloc_size)) == NULL) {
     return -1;
   }
@@ -863,28 +727,34 @@ int route_file_check(int const* const _object_no_list, char const* const _file_n
   memset(mem, 0, alloc_size);
   // ファイルを開く
   if((fp = fopen(_file_name, "r")) == NULL) {
+    free(mem);
     return -2;
   }
-  // 順路数の読み込み
+  // 順路数の読み込み（バッチで繰り返し呼ばれるので、エラー時もメモリとファイルは必ず開放する）
+  ret = 0;
   if(fscanf(fp, "%d", &total) != 1) {
-    return -3;
+    ret = -3;
   }
   // 順路チェック
-  for(i = 0; i < total; ++ i) {
+  for(i = 0; ret == 0 && i < total; ++ i) {
     if(fscanf(fp, "%d", &length) != 1) {
-      return -4;
+      ret = -4;
+      break;
     }
     gen_x = gen_y = gen_z = -1;
     equ_x = equ_y = equ_z = -1;
     for(j = 0; j < length; ++ j) {
-      if(fscanf(fp, "%d %d %d", &x, &y, &z) != 3) {
-        return -5;
+      if(fscanf(fp, "%d %d %d", &x, &y, &z) != 3
+      || x < 0 || SCALE_SIZE <= x || y < 0 || SCALE_SIZE <= y || z < 0 || SCALE_SIZE <= z) {
+        ret = -5;
+        break;
       }
       // 重複チェック
-      if(mem[INDEX(x, y, z)] != 0) {
-        return -6;
+      if(mem[vigne_index(x, y, z)] != 0) {
+        ret = -6;
+        break;
       }
-      mem[INDEX(x, y, z)] = 1;
+      mem[vigne_index(x, y, z)] = 1;
       if(j == 0) {
         gen_x = x;
         gen_y = y;
@@ -896,194 +766,19 @@ int route_file_check(int const* const _object_no_list, char const* const _file_n
       }
     }
     //開始、終了が同じNo.かチェック
-    if(_object_no_list[INDEX(gen_x, gen_y, gen_z)] != _object_no_list[INDEX(equ_x, equ_y, equ_z)]) {
-      return -7;
+    if(ret == 0
+    && (gen_x < 0 || equ_x < 0
+     || vigne_object_no(_solver, vigne_index(gen_x, gen_y, gen_z))
+     != vigne_object_no(_solver, vigne_index(equ_x, equ_y, equ_z)))) {
+      ret = -7;
     }
   }
   // データが残っていないかチェック
-  if(fscanf(fp, "%d", &total) != EOF) {
-    return -8;
+  if(ret == 0 && fscanf(fp, "%d", &total) != EOF) {
+    ret = -8;
   }
   // ファイルを閉じる
   free(mem);
   fclose(fp);
-  return 0;
-}
-
-static uint32_t xorsft_x = 123456789;
-static uint32_t xorsft_y = 362436069;
-static uint32_t xorsft_z = 521288629;
-static uint32_t xorsft_w = 88675123;
-
-//////////////////////////////
-// 乱数seed設定
-//////////////////////////////
-void initrand(uint32_t seed) {
-  do {
-      seed = seed*1812433253 + 1; seed ^= seed<<13; seed ^= seed>>17;
-      xorsft_x = 123464980 ^ seed;
-      seed = seed*1812433253 + 1; seed ^= seed<<13; seed ^= seed>>17;
-      xorsft_y = 3447902351 ^ seed;
-      seed = seed*1812433253 + 1; seed ^= seed<<13; seed ^= seed>>17;
-      xorsft_z = 2859490775 ^ seed;
-      seed = seed*1812433253 + 1; seed ^= seed<<13; seed ^= seed>>17;
-      xorsft_w = 47621719 ^ seed;
-  } while(xorsft_x==0 && xorsft_y==0 && xorsft_z==0 && xorsft_w==0);
-}
-
-//////////////////////////////
-// 0〜1未満の乱数生成
-//////////////////////////////
-double urand() {
-  uint32_t t;
-  t = xorsft_x ^ (xorsft_x<<11);
-  xorsft_x = xorsft_y;
-  xorsft_y = xorsft_z;
-  xorsft_z = xorsft_w;
-  xorsft_w ^= t ^ (t>>8) ^ (xorsft_w>>19);
-  return ((xorsft_x+0.5) / 4294967296.0 + xorsft_w) / 4294967296.0;
+  return ret;
 }
-
-//////////////////////////////
-// Zoning Remove
-//////////////////////////////
-void zoning_remove(route_t const* const _route_parent, route_t* const _route_child) {
-  int begin_x, end_x, width_x;
-  int begin_y, end_y, width_y;
-  int begin_z, end_z, width_z;
-  int x, y, z;
-  int copy_size, route_index;
-
-  // X座標の幅と位置を決める
-  width_x = (int)(urand() * (double)(ZX_WIDTH_MAX - ZX_WIDTH_MIN)) + ZX_WIDTH_MIN;
-  begin_x = (int)(urand() * (double)(SCALE_SIZE - width_x));
-  end_x = begin_x + width_x;
-  // Y座標の幅と位置を決める
-  width_y = (int)(urand() * (double)(ZX_WIDTH_MAX - ZX_WIDTH_MIN)) + ZX_WIDTH_MIN;
-  begin_y = (int)(urand() * (double)(SCALE_SIZE - width_y));
-  end_y = begin_y + width_y;
-  // Z座標の幅と位置を決める
-  width_z = (int)(urand() * (double)(ZX_WIDTH_MAX - ZX_WIDTH_MIN)) + ZX_WIDTH_MIN;
-  begin_z = (int)(urand() * (double)(SCALE_SIZE - width_z));
-  end_z = begin_z + width_z;
-  // 親順路から子順路にコピー
-  copy_size = sizeof(route_t) * SCALE_SIZE * SCALE_SIZE * SCALE_SIZE;
-  memcpy(_route_child, _route_parent, copy_size);
-  // 順路削除
-  for(x = begin_x; x <= end_x; ++ x) {
-    for(y = begin_y; y <= end_y; ++ y) {
-      for(z = begin_z; z <= end_z; ++ z) {
-        route_index = INDEX(x, y, z);
-        // ゾーン内に接している順路を削除
-        zx_remove_route(route_index, _route_child);
-      }
-    }
-  }
-}
-
-//////////////////////////////
-// Zoning Crossover (ZX)
-//////////////////////////////
-// void zx_crossover(object_t const* const _object_list, int const* const _object_no_list, qsort_t const* const _cost_list,
-//                   route_t const* const _route_parent_1, route_t const* const _route_parent_2,
-//                   route_t* const _route_child_1, route_t* const _route_child_2) {
-//   int begin_x, end_x, width_x;
-//   int begin_y, end_y, width_y;
-//   int begin_z, end_z, width_z;
-//   int x, y, z;
-//   int copy_size, route_index;
-
-//   // X座標の幅と位置を決める
-//   width_x = (int)(urand() * (double)(ZX_WIDTH_MAX - ZX_WIDTH_MIN)) + ZX_WIDTH_MIN;
-//   begin_x = (int)(urand() * (double)(SCALE_SIZE - width_x));
-//   end_x = begin_x + width_x;
-//   // Y座標の幅と位置を決める
-//   width_y = (int)(urand() * (double)(ZX_WIDTH_MAX - ZX_WIDTH_MIN)) + ZX_WIDTH_MIN;
-//   begin_y = (int)(urand() * (double)(SCALE_SIZE - width_y));
-//   end_y = begin_y + width_y;
-//   // Z座標の幅と位置を決める
-//   width_z = (int)(urand() * (double)(ZX_WIDTH_MAX - ZX_WIDTH_MIN)) + ZX_WIDTH_MIN;
-//   begin_z = (int)(urand() * (double)(SCALE_SIZE - width_z));
-//   end_z = begin_z + width_z;
-//   // 親順路から子順路にコピー
-//   copy_size = sizeof(route_t) * SCALE_SIZE * SCALE_SIZE * SCALE_SIZE;
-//   memcpy(_route_child_1, _route_parent_1, copy_size);
-//   memcpy(_route_child_2, _route_parent_2, copy_size);
-
-//   for(x = begin_x; x <= end_x; ++ x) {
-//     for(y = begin_y; y <= end_y; ++ y) {
-//       for(z = begin_z; z <= end_z; ++ z) {
-//         route_index = INDEX(x, y, z);
-//         // ゾーン内に接している順路を削除
-//         zx_remove_route(route_index, _route_child_1);
-//         zx_remove_route(route_index, _route_child_2);
-//       }
-//     }
-//   }
-// }
-
-//////////////////////////////
-// ゾーンの内側にルートがあるかどうか判定
-//////////////////////////////
-int zx_inner_zone(int const _begin_x, int const _end_x,
-                  int const _begin_y, int const _end_y,
-                  int const _begin_z, int const _end_z,
-                  int const _route_index, route_t const* const _route_list) {
-  int index;
-  route_t const* rt;
-
-  // NEXT チェック
-  index = _route_index;
-  while(index != -1) {
-    rt = _route_list + index;
-    // はみ出しチェック
-    if(rt->coord.x < _begin_x || _end_x < rt->coord.x
-    || rt->coord.y < _begin_y || _end_y < rt->coord.y
-    || rt->coord.z < _begin_z || _end_z < rt->coord.z) {
-      return 0;
-    }
-    index = rt->next;
-  }
-  // PREV チェック
-  index = _route_index;
-  while(index != -1) {
-    rt = _route_list + index;
-    // はみ出しチェック
-    if(rt->coord.x < _begin_x || _end_x < rt->coord.x
-    || rt->coord.y < _begin_y || _end_y < rt->coord.y
-    || rt->coord.z < _begin_z || _end_z < rt->coord.z) {
-      return 0;
-    }
-    index = rt->prev;
-  }
-  return 1;
-}
-
-//////////////////////////////
-// 指定された順路を削除する
-//////////////////////////////
-void zx_remove_route(int const _route_index, route_t* const _route_list) {
-  int index;
-  route_t* rt;
-
-  // NEXT 削除
-  rt = _route_list + _route_index;
-  index = rt->next;
-  rt->next = -1;
-  while(index != -1) {
-    rt = _route_list + index;
-    index = rt->next;
-    rt->prev = -1;
-    rt->next = -1;
-  }
-  // PREV 削除
-  rt = _route_list + _route_index;
-  index = rt->prev;
-  rt->prev = -1;
-  while(index != -1) {
-    rt = _route_list + index;
-    index = rt->prev;
-    rt->prev = -1;
-    rt->next = -1;
-  }
-}
\ No newline at end of file
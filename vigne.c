@@ -0,0 +1,4427 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <time.h>
+#include <limits.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "vigne.h"
+
+//////////////////////////////
+// マクロ・定数
+//////////////////////////////
+#define OBJECT_SIZE VIGNE_OBJECT_SIZE
+#define SCALE_SIZE VIGNE_SCALE_SIZE
+#define ZX_WIDTH_MIN 3
+#define ZX_WIDTH_MAX 5
+#define GENERATION 30000
+#define ROUTE_SIZE (SCALE_SIZE + SCALE_SIZE + SCALE_SIZE + 2)
+#define TILE_COST_BASE 4
+#define TILE_COST_WEIGHT 16
+#define TILE_COST_FULL 64
+#define REGION_THREAD_MAX 64
+#define COMPACT_INTERVAL 100
+#define EJECT_BUDGET 16
+#define EJECT_DEPTH 2
+#define EJECT_ROUTE_MAX 3
+#define EJECT_LOG_SIZE 64
+#define EJECT_PENALTY 4096
+#define BOUND_TILE_SIZE 4
+#define BOUND_ITERATION 200
+#define BOUND_STALE 20
+#define BOUND_THETA_MIN 0.0001
+#define ELITE_SIZE 16
+#define ELITE_DISTANCE_RATE 20
+#define RELINK_INTERVAL 500
+#define RELINK_SPLIT 2
+#define TABU_SIZE 4096
+#define TABU_RETRY 8
+#define BACKBONE_ACCEPT 20
+#define BACKBONE_RELEASE 100
+#define FROZEN_PRESOLVE 1
+#define FROZEN_BACKBONE 2
+#define EXACT_NODE_MAX 20000
+#define EXACT_MARGIN 2
+#define EXACT_SCALE (ZX_WIDTH_MAX + EXACT_MARGIN * 2)
+#define EXACT_CELL_MAX (EXACT_SCALE * EXACT_SCALE * EXACT_SCALE)
+#define EXACT_WORD ((EXACT_CELL_MAX + 63) / 64)
+#define EXACT_LENGTH_MAX (EXACT_SCALE * 3)
+#define EXACT_PAIR_MAX 24
+#define EXACT_PATH_MAX 32
+#define CONNECT_CANDIDATE 4
+#define CONNECT_CANDIDATE_MAX 8
+#define CONNECT_NODE_MAX 64
+#define LEARN_ELITE_RATE 5
+#define LEARN_ELITE_MAX 64
+#define LEARN_BATCH_MAX VIGNE_LEARN_BATCH_MAX
+#define LEARN_SMOOTH 0.3
+#define LEARN_SIGMA 1.0
+#define LEARN_SIGMA_MIN 0.25
+#define LEARN_SCALE 1000.0
+#define LEARN_NONE (-1e30f)
+#define CELL_COUNT (SCALE_SIZE * SCALE_SIZE * SCALE_SIZE)
+#define INDEX(x,y,z) cell_index((x), (y), (z))
+#define IS_OPEN(rt)  ((rt)->prev == -1 && (rt)->next == -1)
+#define IS_CLOSE(rt) ((rt)->prev != -1 || (rt)->next != -1)
+#define IS_HEAD(rt)  ((rt)->prev == -1 && (rt)->next != -1)
+#define IS_TAIL(rt)  ((rt)->prev != -1 && (rt)->next == -1)
+#define TILE_INDEX(s,x,y,z) (((x) * (s) * (s)) + ((y) * (s)) + (z))
+#define IN_CORRIDOR(kopt,index) ((kopt)->tile_mark == NULL \
+                              || (kopt)->tile_mark[(kopt)->cell_tile[index]] == (kopt)->tile_stamp)
+
+//////////////////////////////
+// 座標からセルのINDEXを求める（並びは VIGNE_CELL_LAYOUT による）
+//////////////////////////////
+#if VIGNE_CELL_LAYOUT == 0
+static inline int cell_index(int const _x, int const _y, int const _z) {
+  return ((_x * SCALE_SIZE * SCALE_SIZE) + (_y * SCALE_SIZE) + _z);
+}
+#else
+// どの並びも軸ごとのオフセットの和になるので、軸ごとの表を引いて足す
+static int cell_offset[3][SCALE_SIZE];
+
+static inline int cell_index(int const _x, int const _y, int const _z) {
+  return cell_offset[0][_x] + cell_offset[1][_y] + cell_offset[2][_z];
+}
+#endif
+
+//////////////////////////////
+// 型定義
+//////////////////////////////
+
+typedef vigne_xyz_t xyz_t;
+
+typedef struct {
+  xyz_t gen; // 発電機の座標
+  xyz_t equ; // 装置の座標
+  int cost;  // 二点間のコスト
+} object_t;
+
+typedef vigne_cell_t route_t;
+
+typedef struct {
+  int key;   // KEY
+  int value; // VALUE
+} qsort_t;
+
+typedef struct {
+  uint32_t x; // xorshift 状態X
+  uint32_t y; // xorshift 状態Y
+  uint32_t z; // xorshift 状態Z
+  uint32_t w; // xorshift 状態W
+} rand_t;
+
+typedef struct {
+  int value;           // 順路数の上界
+  int tile_scale;      // タイルの一辺の数
+  int tile_count;      // タイルの数
+  int stale;           // ラグランジュ緩和の値が更新されていない反復数
+  double best;         // ラグランジュ緩和の最小値
+  double theta;        // ステップ幅の係数（0なら反復しない）
+  double mu;           // 部屋数の制約の乗数
+  double* lambda;      // タイルごとの容量の制約の乗数
+  double* grad;        // タイルごとの劣勾配
+  int* capacity;       // タイルの容量（部屋数）
+  int* length;         // ペアの順路に最低限必要な部屋数（距離 + 1）
+  int* tile;           // ペアの両端のタイル（2つずつ、両端が同じタイルなら2つ目は -1）
+  int* demand;         // ペアの順路が両端のタイルで最低限使う部屋数（2つずつ）
+} bound_t;
+
+typedef struct {
+  int total;      // 順路数
+  int* object_no; // 順路のあるオブジェクトNo.（昇順、total 個）
+  int* code_head; // 順路ごとの方向コードの先頭（ビット位置、total + 1 個）
+  uint8_t* code;  // 方向コード（発電機から1歩ごとに3ビット）
+} elite_t;
+
+typedef struct {
+  xyz_t begin; // 始点
+  xyz_t end;   // 終点（含む）
+} zone_t;
+
+typedef struct {
+  int size;                                   // 操作の数
+  int object_no[EJECT_LOG_SIZE];              // 操作したオブジェクトNo.
+  int head[EJECT_LOG_SIZE + 1];               // 外した順路の先頭（cell_list の位置、つないだ場合は部屋数0）
+  int cell_list[EJECT_LOG_SIZE * ROUTE_SIZE]; // 外した順路の部屋
+} eject_t;
+
+typedef struct {
+  zone_t box;                                               // ゾーンを広げた範囲
+  int pair_size;                                            // 対象のペアの数
+  int object_no[EXACT_PAIR_MAX];                            // 対象のオブジェクトNo.
+  int saved_size[EXACT_PAIR_MAX];                           // 外した順路の部屋数（順路が無ければ 0）
+  int saved_list[EXACT_PAIR_MAX][ROUTE_SIZE];               // 外した順路の部屋
+  int path_size[EXACT_PAIR_MAX];                            // 候補経路の数
+  int path_length[EXACT_PAIR_MAX][EXACT_PATH_MAX];          // 候補経路の部屋数
+  int path_list[EXACT_PAIR_MAX][EXACT_PATH_MAX][EXACT_LENGTH_MAX]; // 候補経路の部屋
+  uint64_t path_bit[EXACT_PAIR_MAX][EXACT_PATH_MAX][EXACT_WORD];  // 候補経路の部屋（範囲内の位置のビット）
+  int order[EXACT_PAIR_MAX];                                // 分枝するペアの順番
+  int choice[EXACT_PAIR_MAX];                               // 探索中の選択（-1 ならつながない）
+  int best_choice[EXACT_PAIR_MAX];                          // 最良の選択
+  uint64_t used[EXACT_WORD];                                // 探索中に使っている部屋
+  int best;                                                 // 最良のつながるペアの数
+  long node;                                                // 探索したノード数
+  long node_limit;                                          // ノード数の上限
+  int depth_path[EXACT_LENGTH_MAX];                         // 候補経路を列挙中の部屋
+} exact_t;
+
+typedef struct {
+  int stamp;                    // 印の値（調べるたびに増やす）
+  int block[VIGNE_CELL_SIZE];   // 候補経路の部屋の印
+  int visit[VIGNE_CELL_SIZE];   // 幅優先探索で訪れた部屋の印
+  int object[OBJECT_SIZE];      // 調べたペアの印
+  int select;                   // 候補経路を選び始めたときの印
+  int before[OBJECT_SIZE];      // 候補経路を置く前のつながりを調べたペアの印（select の値）
+  unsigned char reach[OBJECT_SIZE]; // 候補経路を置く前に両端がつながっていたか
+  int queue[CONNECT_NODE_MAX];  // 幅優先探索の待ち行列
+} connect_t;
+
+typedef struct {
+  object_t const* object_list; // オブジェクト（発電機・装置）リスト
+  int const* object_no_list;   // オブジェクトNo.リスト
+  route_t* route_list;         // 探索中の順路リスト
+  int best_cost;               // 最小コスト
+  int best_route[ROUTE_SIZE];  // 最小コストの順路（装置側から、-1 終端）
+  int const* cell_tile;        // 部屋 → タイル
+  int const* tile_mark;        // 通ってよいタイルの印（NULLなら制限なし）
+  int tile_stamp;              // tile_mark がこの値のタイルだけ通れる
+  int* dp_cost;                // 回廊内の経路探索（DP）用コスト
+  int* dp_from;                // 回廊内の経路探索（DP）用の経路
+  unsigned char const* open_snapshot; // 領域外の部屋の空き状況（NULLなら常に最新を見る）
+  xyz_t region_begin;          // 探索している領域の始点
+  xyz_t region_end;            // 探索している領域の終点（含まない）
+  connect_t* connect;          // 候補経路がペアを閉じ込めるか調べる作業領域（NULLなら調べない）
+  int candidate_max;           // 残す候補経路の数（2未満なら最小コストの1本だけ）
+  int candidate_size;          // 候補経路の数
+  int candidate_cost[CONNECT_CANDIDATE_MAX];              // 候補経路のコスト（昇順）
+  int candidate_route[CONNECT_CANDIDATE_MAX][ROUTE_SIZE]; // 候補経路（装置側から、-1 終端）
+} kopt_t;
+
+typedef struct {
+  pthread_mutex_t mutex; // 排他制御
+  int* list;             // 領域No.
+  int head;              // 先頭（他のワーカーが盗む側）
+  int tail;              // 末尾（持ち主が取り出す側）
+} deque_t;
+
+typedef struct {
+  vigne_solver_t* solver;  // ソルバー
+  qsort_t const* cost_list; // コストリスト
+  route_t* route_list;     // 探索中の順路リスト
+  int worker_no;           // ワーカーNo.
+  int worker_size;         // ワーカー数
+} region_worker_t;
+
+typedef struct {
+  pthread_mutex_t gate;      // ワーカーの起動がそろうまで待たせる
+  pthread_barrier_t barrier; // 窓の探索の開始・終了の同期
+  int begin;                 // 窓の先頭（コストリストの位置）
+  int size;                  // 窓のペアの数（0なら終了）
+  int worker_size;           // 起動できたワーカー数（自分を含む）
+  int* path_size;            // 窓のペアごとに先読みした順路の部屋数（0ならつながらない）
+  int* path_list;            // 先読みした順路の部屋（ペアごとに ROUTE_SIZE 個）
+  int commit_size;           // 窓で確定した順路の数
+  int* commit_head;          // 確定した順路の先頭（commit_list の位置、commit_size + 1 個）
+  int* commit_list;          // 確定した順路の部屋
+} speculation_t;
+
+typedef struct {
+  vigne_solver_t* solver;   // ソルバー
+  qsort_t const* cost_list; // コストリスト
+  route_t* route_list;      // 先読み用の順路リスト（ワーカー0は本体、他は写し）
+  speculation_t* spec;      // 共有状態
+  int worker_no;            // ワーカーNo.
+} speculation_worker_t;
+
+struct vigne_solver {
+  object_t* object_list; // オブジェクト（発電機・装置）リスト
+  int* object_no_list;   // オブジェクトNo.リスト
+  qsort_t* cost_list;    // コストリスト
+  int cost_size;         // コストリストのうち探索対象の数（前処理で固定したペアは含まない）
+  unsigned char* frozen; // 固定した順路の部屋（削除しない、FROZEN_PRESOLVE か FROZEN_BACKBONE）
+  route_t* route_parent; // 親順路
+  route_t* route_child;  // 子順路
+  rand_t rand;           // 乱数の状態
+  vigne_config_t config; // 設定
+  int total;             // 親順路の順路数
+  int stale;             // 親順路が更新されていない世代数
+  long generation;       // 実行した世代数
+  bound_t bound;         // 順路数の上界
+  int elite_size;        // エリート解の数
+  int elite_capacity;    // エリート解の確保数
+  elite_t* elite_list;   // エリート解（順路を方向コードに圧縮して保持する）
+  elite_t elite_work;    // 圧縮作業用（最大の大きさで確保）
+  route_t* route_relink; // パスリリンキングの途中の順路
+  uint64_t hash;         // 親順路のハッシュ値（Zobrist）
+  int tabu_size;         // タブーリストの大きさ（2の冪）
+  uint64_t* tabu_list;   // 改善しなかった（親順路のハッシュ値, ゾーン）の組（0なら空き）
+  exact_t* exact;        // ゾーンの厳密解法の作業領域
+  connect_t* connect;    // 再構築で候補経路を選ぶときの作業領域
+  int* stable_count;     // ペアの順路が変わらずに続いた更新回数
+  uint64_t* stable_hash; // 前回の更新時のペアの順路のハッシュ値（順路が無ければ 0）
+  int backbone_size;     // 骨格として固定したペアの数
+  uint64_t frozen_epoch; // 固定した部屋が変わるたびに増やす（タブーリストのキーに混ぜる）
+  int learn_size;        // 今のバッチで集めた標本の数
+  int learn_batch;       // 分布を更新する世代間隔（config.learn_batch を LEARN_BATCH_MAX までに抑えたもの）
+  double* learn_mean;    // ペアの優先度の平均
+  double* learn_sigma;   // ペアの優先度のばらつき
+  float* learn_sample;   // 標本ごとのペアの優先度（learn_batch 組、探索しなかったペアは LEARN_NONE）
+  int* learn_score;      // 標本ごとの子順路の順路数
+  int* conflict_head;    // ペアごとの衝突するペアの先頭（conflict_list の位置、OBJECT_SIZE + 1 個）
+  int* conflict_list;    // 衝突するペア（探索範囲が重なるペアのオブジェクトNo.）
+  int independent_size;  // 独立集合のペアの数
+  int* independent_list; // 独立集合（互いに衝突しないペアのオブジェクトNo.、コストリストの順）
+  unsigned char* independent_mark; // 独立集合に選んだペアの印
+  unsigned char* independent_snapshot; // 独立集合の探索開始時の部屋の空き状況（領域に分けない場合も使う）
+  int tile_size;         // タイルの一辺（部屋数、0なら階層探索しない）
+  int tile_scale;        // タイルの一辺の数
+  int tile_stamp;        // tile_mark に付ける印
+  int* cell_tile;        // 部屋 → タイル
+  int* tile_capacity;    // タイルの容量（部屋数）
+  int* tile_usage;       // タイルの使用量（部屋数の見積もり）
+  int* tile_mark;        // 回廊に含まれるタイルの印
+  int* tile_cost;        // タイル単位の経路探索用コスト
+  int* tile_from;        // タイル単位の経路探索用の経路
+  int* corridor_head;    // 探索順ごとの回廊の先頭（corridor_list の位置）
+  int* corridor_list;    // 回廊のタイル
+  int* dp_cost;          // 経路探索（DP）用コスト
+  int* dp_from;          // 経路探索（DP）用の経路
+  int region_size;       // 領域の一辺（部屋数、0なら並列探索しない）
+  int region_scale;      // 領域の一辺の数
+  int worker_size;       // 並列探索のワーカー数
+  int* object_region;    // オブジェクトNo. → 探索範囲が収まる領域（収まらなければ -1）
+  int* region_head;      // 領域ごとの探索順の先頭（region_list の位置）
+  int* region_list;      // 領域ごとに並べたコストリストの位置
+  unsigned char* open_snapshot; // 並列探索開始時の部屋の空き状況
+  deque_t* deque_list;   // ワーカーごとの領域の両端キュー
+};
+
+//////////////////////////////
+// プロトタイプ宣言
+//////////////////////////////
+static int load_object_list(object_t* const _object_list,
+                            int const* const _gen_xyz, int const* const _equ_xyz, int const _size);
+static int dist(int const _gen_x, int const _gen_y, int const _gen_z,
+                int const _equ_x, int const _equ_y, int const _equ_z);
+static int init_object_no_list(int* const _object_no_list, object_t const* const _object_list);
+static void init_route_list(route_t* const _route_list);
+static int qsort_desc(void const* const _a, void const* const _b);
+static void init_cost_list(qsort_t* const _cost_list, object_t const* const _object_list,
+                           rand_t* const _rand);
+static void shuffle_cost_list(qsort_t* const _cost_list, int const _size, rand_t* const _rand);
+static void search_route(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                         route_t* const _route_list, int const _parallel);
+static void init_kopt(kopt_t* const _kopt, vigne_solver_t const* const _solver,
+                      route_t* const _route_list);
+static void search_route_by_object_no(kopt_t* const _kopt, int const _object_no);
+static void search_route_by_kopt(kopt_t* const _kopt,
+                                 int const _from_x, int const _from_y, int const _from_z,
+                                 int const _to_x, int const _to_y, int const _to_z);
+static void kopt_local_search(kopt_t* const _kopt,
+                              int const _from_x, int const _from_y, int const _from_z,
+                              int const _to_x, int const _to_y, int const _to_z,
+                              int const _depth, int const _total_cost);
+static void search_route_by_object_no_multi_way(kopt_t* const _kopt, int const _object_no);
+static void search_route_by_kopt_multi_way(kopt_t* const _kopt,
+                                           int const _from_x, int const _from_y, int const _from_z,
+                                           int const _to_x, int const _to_y, int const _to_z);
+static void kopt_multi_way_local_search(kopt_t* const _kopt,
+                                        int const _from_x, int const _from_y, int const _from_z,
+                                        int const _to_x, int const _to_y, int const _to_z,
+                                        int const _depth, int const _total_cost);
+static void kopt_next_call(kopt_t* const _kopt,
+                           int const _from_x, int const _from_y, int const _from_z,
+                           int const _next_x, int const _next_y, int const _next_z,
+                           int const _to_x, int const _to_y, int const _to_z,
+                           int const _depth, int const _total_cost);
+static void kopt_best_judge(kopt_t* const _kopt, int const _x, int const _y, int const _z,
+                            int const _total_cost);
+static void kopt_link_best(kopt_t* const _kopt);
+static void kopt_candidate_add(kopt_t* const _kopt, int const _index, int const _total_cost);
+static void kopt_candidate_select(kopt_t* const _kopt);
+static int connect_seal_cost(kopt_t* const _kopt, int const* const _route, int const _limit);
+static int connect_reach(kopt_t* const _kopt, object_t const* const _obj, int const _block);
+static int kopt_cell_cost(kopt_t const* const _kopt, int const _index);
+static int kopt_is_open(kopt_t const* const _kopt, xyz_t const* const _xyz);
+static int init_tile_list(vigne_solver_t* const _solver);
+static void free_tile_list(vigne_solver_t* const _solver);
+static void search_route_by_tile(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                                 route_t* const _route_list);
+static int tile_route(vigne_solver_t* const _solver, object_t const* const _obj,
+                      int* const _tile_list);
+static int tile_cost(vigne_solver_t const* const _solver, int const _tile);
+static void tile_mark_around(vigne_solver_t* const _solver, int const _tile, int const _stamp);
+static void search_route_by_dp(kopt_t* const _kopt, int const _object_no);
+static void search_route_by_dp_multi_way(kopt_t* const _kopt, int const _object_no);
+static int kopt_dp_search(kopt_t* const _kopt,
+                          int const _from_x, int const _from_y, int const _from_z,
+                          int const _to_x, int const _to_y, int const _to_z,
+                          int const _block_index, int const _penalty, int* const _route);
+static int init_region_list(vigne_solver_t* const _solver);
+static void free_region_list(vigne_solver_t* const _solver);
+static void search_route_by_region(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                                   route_t* const _route_list);
+static void* region_worker(void* _arg);
+static int region_pop(deque_t* const _deque_list, int const _worker_no, int const _worker_size);
+static void search_route_in_region(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                                   route_t* const _route_list, int const _region);
+static void search_route_pair(kopt_t* const _kopt, int const _object_no);
+static int search_route_by_speculation(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                                       route_t* const _route_list);
+static void* speculation_worker(void* _arg);
+static void speculation_search(speculation_worker_t* const _worker);
+static void speculation_commit(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                               route_t* const _route_list, speculation_t* const _spec);
+static int speculation_conflict(vigne_solver_t const* const _solver, route_t const* const _route_list,
+                                speculation_t const* const _spec, object_t const* const _obj);
+static int compact_route(vigne_solver_t* const _solver, route_t* const _route_list);
+static void compact_search(vigne_solver_t const* const _solver, kopt_t* const _kopt, int const _object_no);
+static int compact_cost(kopt_t const* const _kopt, int const* const _list, int const _size);
+static int compact_unlink(route_t* const _route_list, int const _head, int* const _list);
+static void compact_link(route_t* const _route_list, int const* const _list, int const _size);
+static void eject_route_by_zone(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                                route_t* const _route_list, zone_t const* const _zone);
+static int eject_chain(vigne_solver_t* const _solver, kopt_t* const _kopt, eject_t* const _eject,
+                       int const _object_no, int const _depth);
+static void eject_undo(object_t const* const _object_list, route_t* const _route_list,
+                       eject_t* const _eject, int const _size);
+static int exact_route_by_zone(vigne_solver_t* const _solver, route_t* const _route_list,
+                               zone_t const* const _zone);
+static int exact_local(exact_t const* const _exact, int const _x, int const _y, int const _z);
+static void exact_path(vigne_solver_t* const _solver, exact_t* const _exact, route_t const* const _route_list,
+                       int const _pair, int const _x, int const _y, int const _z,
+                       int const _to_x, int const _to_y, int const _to_z, int const _depth);
+static void exact_branch(exact_t* const _exact, int const _k, int const _routed);
+static int init_bound(vigne_solver_t* const _solver);
+static void free_bound(bound_t* const _bound);
+static int bound_exit(int const _x, int const _y, int const _z, int const _tile_size);
+static void bound_iterate(vigne_solver_t* const _solver, int const _iteration);
+static int init_elite_list(vigne_solver_t* const _solver);
+static void free_elite_list(vigne_solver_t* const _solver);
+static void elite_encode(vigne_solver_t const* const _solver, route_t const* const _route_list,
+                         elite_t* const _elite);
+static int elite_decode(vigne_solver_t const* const _solver, elite_t const* const _elite, int const _no,
+                        int* const _list);
+static int elite_distance(elite_t const* const _a, elite_t const* const _b);
+static void elite_offer(vigne_solver_t* const _solver, route_t const* const _route_list, int const _total);
+static int path_relink(vigne_solver_t* const _solver, elite_t const* const _elite);
+static void init_cell_offset(void);
+static int presolve(vigne_solver_t* const _solver, route_t* const _route_list);
+static int count_route(object_t const* const _object_list, route_t const* const _route_list);
+static void initrand(rand_t* const _rand, uint32_t seed);
+static double urand(rand_t* const _rand);
+static double get_time();
+static int init_tabu_list(vigne_solver_t* const _solver);
+static void free_tabu_list(vigne_solver_t* const _solver);
+static uint64_t hash_mix(uint64_t _key);
+static uint64_t hash_route_list(route_t const* const _route_list);
+static uint64_t tabu_key(vigne_solver_t const* const _solver, zone_t const* const _zone);
+static int tabu_find(vigne_solver_t const* const _solver, uint64_t const _key);
+static void tabu_insert(vigne_solver_t* const _solver, uint64_t const _key);
+static int init_backbone_list(vigne_solver_t* const _solver);
+static void free_backbone_list(vigne_solver_t* const _solver);
+static void backbone_update(vigne_solver_t* const _solver);
+static void backbone_release(vigne_solver_t* const _solver);
+static int init_learn_list(vigne_solver_t* const _solver);
+static void free_learn_list(vigne_solver_t* const _solver);
+static void learn_sample(vigne_solver_t* const _solver);
+static void learn_record(vigne_solver_t* const _solver, int const _total);
+static void learn_update(vigne_solver_t* const _solver);
+static void search_box(object_t const* const _obj, int* const _lo, int* const _hi);
+static int init_conflict_graph(vigne_solver_t* const _solver);
+static void free_conflict_graph(vigne_solver_t* const _solver);
+static void search_route_by_independent(vigne_solver_t* const _solver, route_t* const _route_list);
+static void* independent_worker(void* _arg);
+static void zoning_sample(rand_t* const _rand, zone_t* const _zone);
+static void zoning_remove(route_t const* const _route_parent, route_t* const _route_child,
+                          unsigned char const* const _frozen, zone_t const* const _zone);
+// static void zx_crossover(object_t const* const _object_list, int const* const _object_no_list, qsort_t const* const _cost_list,
+//                          route_t const* const _route_parent_1, route_t const* const _route_parent_2,
+//                          route_t* const _route_child_1, route_t* const _route_child_2);
+static int zx_inner_zone(int const _begin_x, int const _end_x,
+                         int const _begin_y, int const _end_y,
+                         int const _begin_z, int const _end_z,
+                         int const _route_index, route_t const* const _route_list);
+static void zx_remove_route(int const _route_index, route_t* const _route_list,
+                            unsigned char const* const _frozen);
+
+//////////////////////////////
+// 設定を既定値で初期化
+//////////////////////////////
+void vigne_config_init(vigne_config_t* const _config) {
+  _config->seed = (unsigned int)time(NULL);
+  _config->stagnation = GENERATION;
+  _config->tile_size = 0;
+  _config->threads = 0;
+  _config->region_size = SCALE_SIZE / 2;
+  _config->compact_interval = COMPACT_INTERVAL;
+  _config->eject_budget = EJECT_BUDGET;
+  _config->gap_limit = 0.0;
+  _config->elite_size = ELITE_SIZE;
+  _config->relink_interval = RELINK_INTERVAL;
+  _config->presolve = 1;
+  _config->tabu_size = TABU_SIZE;
+  _config->backbone_accept = BACKBONE_ACCEPT;
+  _config->backbone_release = BACKBONE_RELEASE;
+  _config->exact_nodes = EXACT_NODE_MAX;
+  _config->speculate_window = 0;
+  _config->connect_candidates = CONNECT_CANDIDATE;
+  _config->learn_batch = 0;
+  _config->conflict_length = 0;
+  _config->on_update = NULL;
+  _config->user = NULL;
+}
+
+//////////////////////////////
+// ソルバー生成
+//////////////////////////////
+vigne_solver_t* vigne_create(int const* const _gen_xyz, int const* const _equ_xyz, int const _size,
+                             vigne_config_t const* const _config) {
+  vigne_solver_t* mem = NULL;
+
+  // セルの並びの準備
+  init_cell_offset();
+  // メモリ確保
+  if((mem = (vigne_solver_t*)malloc(sizeof(vigne_solver_t))) == NULL) {
+    return NULL;
+  }
+  mem->object_list = (object_t*)malloc(sizeof(object_t) * OBJECT_SIZE);
+  mem->object_no_list = (int*)malloc(sizeof(int) * VIGNE_CELL_SIZE);
+  mem->cost_list = (qsort_t*)malloc(sizeof(qsort_t) * OBJECT_SIZE);
+  mem->route_parent = (route_t*)malloc(sizeof(route_t) * VIGNE_CELL_SIZE);
+  mem->route_child = (route_t*)malloc(sizeof(route_t) * VIGNE_CELL_SIZE);
+  mem->frozen = (unsigned char*)malloc(sizeof(unsigned char) * VIGNE_CELL_SIZE);
+  mem->dp_cost = (int*)malloc(sizeof(int) * VIGNE_CELL_SIZE);
+  mem->dp_from = (int*)malloc(sizeof(int) * VIGNE_CELL_SIZE);
+  mem->tile_size = 0;
+  mem->tile_scale = 0;
+  mem->cell_tile = NULL;
+  mem->tile_capacity = NULL;
+  mem->tile_usage = NULL;
+  mem->tile_mark = NULL;
+  mem->tile_cost = NULL;
+  mem->tile_from = NULL;
+  mem->corridor_head = NULL;
+  mem->corridor_list = NULL;
+  mem->region_size = 0;
+  mem->region_scale = 0;
+  mem->worker_size = 0;
+  mem->object_region = NULL;
+  mem->region_head = NULL;
+  mem->region_list = NULL;
+  mem->open_snapshot = NULL;
+  mem->deque_list = NULL;
+  mem->elite_size = 0;
+  mem->elite_capacity = 0;
+  mem->elite_list = NULL;
+  mem->elite_work.object_no = NULL;
+  mem->elite_work.code_head = NULL;
+  mem->elite_work.code = NULL;
+  mem->route_relink = NULL;
+  mem->tabu_size = 0;
+  mem->tabu_list = NULL;
+  mem->exact = (exact_t*)malloc(sizeof(exact_t));
+  mem->connect = (connect_t*)malloc(sizeof(connect_t));
+  mem->stable_count = NULL;
+  mem->stable_hash = NULL;
+  mem->backbone_size = 0;
+  mem->frozen_epoch = 0;
+  mem->learn_size = 0;
+  mem->learn_batch = 0;
+  mem->learn_mean = NULL;
+  mem->learn_sigma = NULL;
+  mem->learn_sample = NULL;
+  mem->learn_score = NULL;
+  mem->conflict_head = NULL;
+  mem->conflict_list = NULL;
+  mem->independent_size = 0;
+  mem->independent_list = NULL;
+  mem->independent_mark = NULL;
+  mem->independent_snapshot = NULL;
+  mem->bound.lambda = NULL;
+  mem->bound.grad = NULL;
+  mem->bound.capacity = NULL;
+  mem->bound.length = NULL;
+  mem->bound.tile = NULL;
+  mem->bound.demand = NULL;
+  if(mem->object_list == NULL || mem->object_no_list == NULL || mem->cost_list == NULL
+  || mem->route_parent == NULL || mem->route_child == NULL
+  || mem->dp_cost == NULL || mem->dp_from == NULL || mem->frozen == NULL || mem->exact == NULL
+  || mem->connect == NULL) {
+    vigne_destroy(mem);
+    return NULL;
+  }
+  memset(mem->connect, 0, sizeof(connect_t));
+  // 設定
+  if(_config != NULL) {
+    mem->config = *_config;
+  } else {
+    vigne_config_init(&mem->config);
+  }
+  // 読み込みと初期順路の構築
+  if(vigne_load(mem, _gen_xyz, _equ_xyz, _size, NULL) != 0) {
+    vigne_destroy(mem);
+    return NULL;
+  }
+  return mem;
+}
+
+//////////////////////////////
+// インスタンス読み込み
+//////////////////////////////
+int vigne_load(vigne_solver_t* const _solver,
+               int const* const _gen_xyz, int const* const _equ_xyz, int const _size,
+               vigne_config_t const* const _config) {
+  // 設定
+  if(_config != NULL) {
+    _solver->config = *_config;
+  }
+  initrand(&_solver->rand, _solver->config.seed);
+  _solver->total = 0;
+  _solver->stale = 0;
+  _solver->generation = 0;
+
+  // オブジェクト（発電機・装置）リスト、オブジェクトNo.リスト
+  if(load_object_list(_solver->object_list, _gen_xyz, _equ_xyz, _size) != 0) {
+    return -1;
+  }
+  if(init_object_no_list(_solver->object_no_list, _solver->object_list) != 0) {
+    return -2;
+  }
+  // 階層探索用のタイル
+  if(init_tile_list(_solver) != 0) {
+    return -3;
+  }
+  // 並列探索用の領域
+  if(init_region_list(_solver) != 0) {
+    return -4;
+  }
+  // 順路数の上界
+  if(init_bound(_solver) != 0) {
+    return -5;
+  }
+  // エリート解
+  if(init_elite_list(_solver) != 0) {
+    return -6;
+  }
+  // タブーリスト
+  if(init_tabu_list(_solver) != 0) {
+    return -8;
+  }
+  // 骨格（変わらない順路）の統計
+  if(init_backbone_list(_solver) != 0) {
+    return -9;
+  }
+  // 探索順の学習（ペアの優先度の分布）
+  if(init_learn_list(_solver) != 0) {
+    return -10;
+  }
+  // コストリスト、順路リスト（領域は使い回す）
+  init_cost_list(_solver->cost_list, _solver->object_list, &_solver->rand);
+  init_route_list(_solver->route_parent);
+  // 前処理（つなぐしかないペアを固定して、コストリストから外す）
+  _solver->cost_size = OBJECT_SIZE;
+  memset(_solver->frozen, 0, sizeof(unsigned char) * VIGNE_CELL_SIZE);
+  if(_solver->config.presolve && presolve(_solver, _solver->route_parent) != 0) {
+    return -7;
+  }
+  // 探索範囲が重なるペアの衝突グラフ（前処理で固定したペアは含まない）
+  if(init_conflict_graph(_solver) != 0) {
+    return -11;
+  }
+  // 順路検索
+  search_route(_solver, _solver->cost_list, _solver->route_parent, 1);
+  _solver->total = count_route(_solver->object_list, _solver->route_parent);
+  _solver->hash = hash_route_list(_solver->route_parent);
+  // 上界を絞り込む
+  bound_iterate(_solver, BOUND_ITERATION);
+  elite_offer(_solver, _solver->route_parent, _solver->total);
+  return 0;
+}
+
+//////////////////////////////
+// ソルバー開放
+//////////////////////////////
+void vigne_destroy(vigne_solver_t* const _solver) {
+  if(_solver == NULL) {
+    return;
+  }
+  free(_solver->object_list);
+  free(_solver->object_no_list);
+  free(_solver->cost_list);
+  free(_solver->route_parent);
+  free(_solver->route_child);
+  free(_solver->frozen);
+  free(_solver->exact);
+  free(_solver->connect);
+  free(_solver->dp_cost);
+  free(_solver->dp_from);
+  free_tile_list(_solver);
+  free_region_list(_solver);
+  free_bound(&_solver->bound);
+  free_elite_list(_solver);
+  free_tabu_list(_solver);
+  free_backbone_list(_solver);
+  free_learn_list(_solver);
+  free_conflict_graph(_solver);
+  free(_solver);
+}
+
+//////////////////////////////
+// 1世代進める
+//////////////////////////////
+int vigne_step(vigne_solver_t* const _solver) {
+  int i, total_child, no;
+  uint64_t key;
+  route_t* route_temp = NULL;
+  zone_t zone;
+
+  ++ _solver->generation;
+  // 上界を少しずつ絞り込む
+  bound_iterate(_solver, 1);
+  // ゾーンを選ぶ（今の親順路で改善しなかったゾーンは選び直す）
+  zoning_sample(&_solver->rand, &zone);
+  key = tabu_key(_solver, &zone);
+  for(i = 0; i < TABU_RETRY && tabu_find(_solver, key); ++ i) {
+    zoning_sample(&_solver->rand, &zone);
+    key = tabu_key(_solver, &zone);
+  }
+  // 選び直しても改善しなかったゾーンばかりなら、再構築を省く
+  if(!tabu_find(_solver, key)) {
+    // ゾーン削除
+    zoning_remove(_solver->route_parent, _solver->route_child, _solver->frozen, &zone);
+    // 学習した優先度の分布から探索順を引く
+    if(_solver->learn_mean != NULL) {
+      learn_sample(_solver);
+    } else {
+      // ランダムにシャッフル
+      shuffle_cost_list(_solver->cost_list, _solver->cost_size, &_solver->rand);
+      // コストが高い順にソート
+      qsort(_solver->cost_list, _solver->cost_size, sizeof(qsort_t), qsort_desc);
+    }
+    // 順路再構築（ゾーンは小さいので、スレッドを起動するより逐次の方が速い）
+    search_route(_solver, _solver->cost_list, _solver->route_child, 0);
+    // ゾーンの近くでつながらなかったペアは、邪魔な順路を押しのけてつなぐ
+    eject_route_by_zone(_solver, _solver->cost_list, _solver->route_child, &zone);
+    // ゾーンの中に収まるペアは、つなぎ方を厳密に探し直す
+    exact_route_by_zone(_solver, _solver->route_child, &zone);
+    // 順路数
+    total_child = count_route(_solver->object_list, _solver->route_child);
+    // 探索順の評価
+    if(_solver->learn_mean != NULL) {
+      learn_record(_solver, total_child);
+    }
+    // エリート解の候補
+    elite_offer(_solver, _solver->route_child, total_child);
+    // 更新
+    if(total_child > _solver->total) {
+      _solver->total = total_child;
+      route_temp = _solver->route_parent;
+      _solver->route_parent = _solver->route_child;
+      _solver->route_child = route_temp;
+      _solver->hash = hash_route_list(_solver->route_parent);
+      if(_solver->config.on_update != NULL) {
+        _solver->config.on_update(_solver->config.user, _solver, _solver->total, _solver->stale);
+      }
+      _solver->stale = 0;
+      backbone_update(_solver);
+      return 1;
+    }
+    // 改善しなかった組を覚えておく
+    tabu_insert(_solver, key);
+  }
+  ++ _solver->stale;
+  // 停滞したら骨格の固定を外す
+  if(_solver->stale == _solver->config.backbone_release) {
+    backbone_release(_solver);
+  }
+  // 定期的に親順路を詰め直して、空いた部屋で他のペアをつなぐ
+  if(_solver->config.compact_interval > 0 && _solver->generation % _solver->config.compact_interval == 0) {
+    total_child = compact_route(_solver, _solver->route_parent);
+    // 詰め直しで順路が変わる
+    _solver->hash = hash_route_list(_solver->route_parent);
+    if(total_child > _solver->total) {
+      _solver->total = total_child;
+      if(_solver->config.on_update != NULL) {
+        _solver->config.on_update(_solver->config.user, _solver, _solver->total, _solver->stale);
+      }
+      _solver->stale = 0;
+      elite_offer(_solver, _solver->route_parent, _solver->total);
+      backbone_update(_solver);
+      return 1;
+    }
+  }
+  // 定期的に、エリート解の順路を領域ごとに取り込みながら探索する（パスリリンキング）
+  if(_solver->config.relink_interval > 0 && _solver->generation % _solver->config.relink_interval == 0
+  && _solver->elite_size >= 2) {
+    no = (int)(urand(&_solver->rand) * (double)_solver->elite_size);
+    if(path_relink(_solver, _solver->elite_list + no)) {
+      _solver->hash = hash_route_list(_solver->route_parent);
+      backbone_update(_solver);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+//////////////////////////////
+// 制限時間・世代数・停滞まで進める
+//////////////////////////////
+int vigne_run(vigne_solver_t* const _solver, double const _time_limit, long const _generation) {
+  long i;
+  double begin_time;
+
+  begin_time = get_time();
+  for(i = 0; _generation <= 0 || i < _generation; ++ i) {
+    // 停滞
+    if(_solver->stale >= _solver->config.stagnation) {
+      break;
+    }
+    // 上界との差が閉じた
+    if(_solver->total >= _solver->bound.value
+    || (double)(_solver->bound.value - _solver->total) <= _solver->config.gap_limit * (double)_solver->bound.value) {
+      break;
+    }
+    // 制限時間
+    if(_time_limit > 0.0 && get_time() - begin_time >= _time_limit) {
+      break;
+    }
+    vigne_step(_solver);
+  }
+  return _solver->total;
+}
+
+//////////////////////////////
+// 現在の順路数
+//////////////////////////////
+int vigne_score(vigne_solver_t const* const _solver) {
+  return _solver->total;
+}
+
+//////////////////////////////
+// 順路数の上界
+//////////////////////////////
+int vigne_bound(vigne_solver_t const* const _solver) {
+  return _solver->bound.value;
+}
+
+//////////////////////////////
+// 実行した世代数
+//////////////////////////////
+long vigne_generation(vigne_solver_t const* const _solver) {
+  return _solver->generation;
+}
+
+//////////////////////////////
+// 座標からセルのINDEXを求める（範囲外なら -1）
+//////////////////////////////
+int vigne_index(int const _x, int const _y, int const _z) {
+  // 範囲外の座標（オフセット表の外を読まない）
+  if(_x < 0 || SCALE_SIZE <= _x || _y < 0 || SCALE_SIZE <= _y || _z < 0 || SCALE_SIZE <= _z) {
+    return -1;
+  }
+  init_cell_offset();
+  return INDEX(_x, _y, _z);
+}
+
+//////////////////////////////
+// 軸ごとのオフセット表初期化（最初の1回だけ）
+//////////////////////////////
+#if VIGNE_CELL_LAYOUT == 0
+static void init_cell_offset(void) {
+}
+#else
+static pthread_once_t cell_offset_once = PTHREAD_ONCE_INIT;
+
+static void init_cell_offset_once(void) {
+#if VIGNE_CELL_LAYOUT == 1
+  int i, k;
+  int const scale = VIGNE_SCALE_ALIGN / VIGNE_CELL_BLOCK;
+  int const block = VIGNE_CELL_BLOCK * VIGNE_CELL_BLOCK * VIGNE_CELL_BLOCK;
+  int const outer[3] = {scale * scale * block, scale * block, block};
+  int const inner[3] = {VIGNE_CELL_BLOCK * VIGNE_CELL_BLOCK, VIGNE_CELL_BLOCK, 1};
+
+  // ブロックの順番（X,Y,Z順）×ブロックの部屋数＋ブロック内の順番（X,Y,Z順）
+  for(k = 0; k < 3; ++ k) {
+    for(i = 0; i < SCALE_SIZE; ++ i) {
+      cell_offset[k][i] = (i / VIGNE_CELL_BLOCK) * outer[k] + (i % VIGNE_CELL_BLOCK) * inner[k];
+    }
+  }
+#else
+  int i, k, v, bit;
+
+  // 座標のビットを3ビット間隔に広げて、X,Y,Zの順に上位から並べる
+  for(k = 0; k < 3; ++ k) {
+    for(i = 0; i < SCALE_SIZE; ++ i) {
+      v = 0;
+      for(bit = 0; (i >> bit) != 0; ++ bit) {
+        v |= ((i >> bit) & 1) << (bit * 3 + (2 - k));
+      }
+      cell_offset[k][i] = v;
+    }
+  }
+#endif
+}
+
+static void init_cell_offset(void) {
+  pthread_once(&cell_offset_once, init_cell_offset_once);
+}
+#endif
+
+//////////////////////////////
+// 内部の順路グリッド
+//////////////////////////////
+vigne_cell_t const* vigne_grid(vigne_solver_t const* const _solver) {
+  return _solver->route_parent;
+}
+
+//////////////////////////////
+// オブジェクトNo.の順路の先頭INDEX
+//////////////////////////////
+int vigne_route_head(vigne_solver_t const* const _solver, int const _object_no) {
+  object_t const* obj;
+  int index;
+
+  if(_object_no < 0 || OBJECT_SIZE <= _object_no) {
+    return -1;
+  }
+  obj = _solver->object_list + _object_no;
+  index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+  return IS_HEAD(_solver->route_parent + index) ? index : -1;
+}
+
+//////////////////////////////
+// セルに置かれたオブジェクトNo.
+//////////////////////////////
+int vigne_object_no(vigne_solver_t const* const _solver, int const _index) {
+  if(_index < 0 || VIGNE_CELL_SIZE <= _index) {
+    return -1;
+  }
+  return _solver->object_no_list[_index];
+}
+
+//////////////////////////////
+// オブジェクト（発電機・装置）リスト読み込み
+//////////////////////////////
+static int load_object_list(object_t* const _object_list,
+                            int const* const _gen_xyz, int const* const _equ_xyz, int const _size) {
+  int i;
+  object_t* obj;
+
+  // 個数チェック
+  if(_size != OBJECT_SIZE) {
+    return -1;
+  }
+  // 座標読み込み
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    obj = _object_list + i;
+    obj->gen.x = _gen_xyz[i * 3 + 0];
+    obj->gen.y = _gen_xyz[i * 3 + 1];
+    obj->gen.z = _gen_xyz[i * 3 + 2];
+    obj->equ.x = _equ_xyz[i * 3 + 0];
+    obj->equ.y = _equ_xyz[i * 3 + 1];
+    obj->equ.z = _equ_xyz[i * 3 + 2];
+    // 範囲チェック
+    if(obj->gen.x < 0 || SCALE_SIZE <= obj->gen.x
+    || obj->gen.y < 0 || SCALE_SIZE <= obj->gen.y
+    || obj->gen.z < 0 || SCALE_SIZE <= obj->gen.z
+    || obj->equ.x < 0 || SCALE_SIZE <= obj->equ.x
+    || obj->equ.y < 0 || SCALE_SIZE <= obj->equ.y
+    || obj->equ.z < 0 || SCALE_SIZE <= obj->equ.z) {
+      return -2;
+    }
+    // コスト
+    obj->cost = (SCALE_SIZE + SCALE_SIZE + SCALE_SIZE)
+              - dist(obj->gen.x, obj->gen.y, obj->gen.z, obj->equ.x, obj->equ.y, obj->equ.z);
+    // DEBUG
+    // printf("obj[%04d] gen: %02d %02d %02d | equ: %02d %02d %02d | cost: %d\n",
+    //        i, obj->gen.x, obj->gen.y, obj->gen.z,
+    //        obj->equ.x, obj->equ.y, obj->equ.z, obj->cost);
+  } 
+  return 0;
+}
+
+//////////////////////////////
+// オブジェクトNo.リスト初期化
+//////////////////////////////
+static int init_object_no_list(int* const _object_no_list, object_t const* const _object_list) {
+  int i, index_gen, index_equ;
+  object_t const* obj;
+
+  // オブジェクトが置かれていない部屋は -1
+  for(i = 0; i < VIGNE_CELL_SIZE; ++ i) {
+    _object_no_list[i] = -1;
+  }
+  // No.紐付け（1部屋に2つ以上置かれていたらエラー）
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    obj = _object_list + i;
+    index_gen = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    index_equ = INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
+    if(_object_no_list[index_gen] != -1 || _object_no_list[index_equ] != -1
+    || index_gen == index_equ) {
+      return -1;
+    }
+    _object_no_list[index_gen] = i;
+    _object_no_list[index_equ] = i;
+  }
+  return 0;
+}
+
+//////////////////////////////
+// 二点間の最短距離を求める
+//////////////////////////////
+static int dist(int const _gen_x, int const _gen_y, int const _gen_z,
+                int const _equ_x, int const _equ_y, int const _equ_z) {
+  return abs(_gen_x - _equ_x) + abs(_gen_y - _equ_y) + abs(_gen_z - _equ_z);
+}
+
+
+//////////////////////////////
+// ソート用比較関数
+//////////////////////////////
+static int qsort_desc(void const* const _a, void const* const _b) {
+  qsort_t const* const a = (qsort_t const*)_a;
+  qsort_t const* const b = (qsort_t const*)_b;
+  return b->value - a->value;
+}
+
+
+//////////////////////////////
+// コストリスト初期化
+//////////////////////////////
+static void init_cost_list(qsort_t* const _cost_list, object_t const* const _object_list,
+                           rand_t* const _rand) {
+  int i;
+  qsort_t* qs;
+
+  // key と value をセット
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    qs = _cost_list + i;
+    qs->key = i;
+    qs->value = _object_list[i].cost;
+  }
+  // ランダムにシャッフル
+  shuffle_cost_list(_cost_list, OBJECT_SIZE, _rand);
+  // コストが高い順にソート
+  qsort(_cost_list, OBJECT_SIZE, sizeof(qsort_t), qsort_desc);
+}
+
+
+//////////////////////////////
+// コストリストをランダムにシャッフル
+//////////////////////////////
+static void shuffle_cost_list(qsort_t* const _cost_list, int const _size, rand_t* const _rand) {
+  int i, r;
+  qsort_t tmp;
+
+  for(i = 0; i < _size; ++ i) {
+    r = (int)(urand(_rand) * (double)_size);
+    tmp = _cost_list[i];
+    _cost_list[i] = _cost_list[r];
+    _cost_list[r] = tmp;
+  }
+}
+
+
+//////////////////////////////
+// 順路リスト初期化
+//////////////////////////////
+static void init_route_list(route_t* const _route_list) {
+  int i, x, y, z;
+  route_t* rt;
+
+  // 切り上げではみ出したセルは座標 -1
+  for(i = 0; i < VIGNE_CELL_SIZE; ++ i) {
+    rt = _route_list + i;
+    rt->prev = -1;
+    rt->next = -1;
+    rt->coord.x = -1;
+    rt->coord.y = -1;
+    rt->coord.z = -1;
+  }
+  for(x = 0; x < SCALE_SIZE; ++ x) {
+    for(y = 0; y < SCALE_SIZE; ++ y) {
+      for(z = 0; z < SCALE_SIZE; ++ z) {
+        rt = _route_list + INDEX(x, y, z);
+        rt->prev = -1;
+        rt->next = -1;
+        rt->coord.x = x;
+        rt->coord.y = y;
+        rt->coord.z = z;
+      }
+    }
+  }
+}
+
+
+//////////////////////////////
+// 順路探索
+//////////////////////////////
+static void search_route(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                         route_t* const _route_list, int const _parallel) {
+  int i;
+  kopt_t kopt;
+
+  // 階層探索
+  if(_solver->config.tile_size > 0) {
+    search_route_by_tile(_solver, _cost_list, _route_list);
+    return;
+  }
+  // 互いに衝突しないペアを先に並列に探索し、残りは以下の方法で探索する
+  if(_parallel && _solver->config.threads > 1 && _solver->conflict_head != NULL) {
+    search_route_by_independent(_solver, _route_list);
+  }
+  // 窓ごとの先読み並列探索（結果は順番に探索した場合と同じ）
+  if(_parallel && _solver->config.threads > 1 && _solver->config.speculate_window > 0
+  && search_route_by_speculation(_solver, _cost_list, _route_list) == 0) {
+    return;
+  }
+  // 領域ごとの並列探索
+  if(_parallel && _solver->region_size > 0) {
+    search_route_by_region(_solver, _cost_list, _route_list);
+    return;
+  }
+  init_kopt(&kopt, _solver, _route_list);
+  // 再構築では候補経路を複数残し、まだつながっていないペアを閉じ込めない経路を選ぶ
+  if(!_parallel && _solver->config.connect_candidates > 1) {
+    kopt.connect = _solver->connect;
+    kopt.candidate_max = _solver->config.connect_candidates < CONNECT_CANDIDATE_MAX
+                       ? _solver->config.connect_candidates : CONNECT_CANDIDATE_MAX;
+  }
+  // 順番に探索（局所）
+  for(i = 0; i < _solver->cost_size; ++ i) {
+    search_route_pair(&kopt, _cost_list[i].key);
+  }
+}
+
+//////////////////////////////
+// 1つのペアの順路探索（単方向でつながらなければ全方向）
+//////////////////////////////
+static void search_route_pair(kopt_t* const _kopt, int const _object_no) {
+  object_t const* obj;
+  route_t* rt_gen;
+  route_t* rt_equ;
+
+  obj = _kopt->object_list + _object_no;
+  rt_gen = _kopt->route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+  rt_equ = _kopt->route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
+  // 単方向探索
+  if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+    search_route_by_object_no(_kopt, _object_no);
+  }
+  // 全方向探索
+  if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+    search_route_by_object_no_multi_way(_kopt, _object_no);
+  }
+}
+
+//////////////////////////////
+// K-OPT 探索条件の初期化
+//////////////////////////////
+static void init_kopt(kopt_t* const _kopt, vigne_solver_t const* const _solver,
+                      route_t* const _route_list) {
+  _kopt->object_list = _solver->object_list;
+  _kopt->object_no_list = _solver->object_no_list;
+  _kopt->route_list = _route_list;
+  _kopt->best_cost = INT_MAX;
+  _kopt->best_route[0] = -1;
+  _kopt->cell_tile = _solver->cell_tile;
+  _kopt->tile_mark = NULL;
+  _kopt->tile_stamp = 0;
+  _kopt->dp_cost = _solver->dp_cost;
+  _kopt->dp_from = _solver->dp_from;
+  _kopt->open_snapshot = NULL;
+  _kopt->connect = NULL;
+  _kopt->candidate_max = 0;
+  _kopt->candidate_size = 0;
+}
+
+//////////////////////////////
+// オブジェクトNo.を指定して順路探索
+//////////////////////////////
+static void search_route_by_object_no(kopt_t* const _kopt, int const _object_no) {
+  object_t const* obj;
+
+  // 発電機と装置をつなぐ順路探索
+  obj = _kopt->object_list + _object_no;
+  search_route_by_kopt(_kopt,
+                       obj->gen.x, obj->gen.y, obj->gen.z,
+                       obj->equ.x, obj->equ.y, obj->equ.z);
+}
+
+//////////////////////////////
+// K-OPT 順路探索
+//////////////////////////////
+static void search_route_by_kopt(kopt_t* const _kopt,
+                                 int const _from_x, int const _from_y, int const _from_z,
+                                 int const _to_x, int const _to_y, int const _to_z) {
+  // 順路探索
+  _kopt->best_cost = INT_MAX;
+  _kopt->candidate_size = 0;
+  kopt_local_search(_kopt,
+                    _from_x, _from_y, _from_z,
+                    _to_x, _to_y, _to_z,
+                    1, 0);
+  // 候補経路を残した場合は、その中から選ぶ
+  if(_kopt->candidate_max > 1) {
+    kopt_candidate_select(_kopt);
+  }
+  // 順路が見つかった場合
+  if(_kopt->best_cost < INT_MAX) {
+    kopt_link_best(_kopt);
+  }
+}
+
+//////////////////////////////
+// K-OPT 局所的な順路探索
+//////////////////////////////
+static void kopt_local_search(kopt_t* const _kopt,
+                              int const _from_x, int const _from_y, int const _from_z,
+                              int const _to_x, int const _to_y, int const _to_z,
+                              int const _depth, int const _total_cost) {
+  int delta_x, delta_y, delta_z;
+ 
+  // 順路が目的地点に到達した場合、記録判定と更新
+  if(_from_x == _to_x && _from_y == _to_y && _from_z == _to_z) {
+    kopt_best_judge(_kopt, _from_x, _from_y, _from_z, _total_cost);
+    return;
+  }
+  // Z移動（プラス方向）
+  delta_z = _to_z - _from_z;
+  if(delta_z > 0) {
+    kopt_next_call(_kopt,
+                   _from_x, _from_y, _from_z,
+                   _from_x, _from_y, _from_z + 1,
+                   _to_x, _to_y, _to_z,
+                   _depth, _total_cost);
+  }
+  // Z移動（マイナス方向）
+  else if(delta_z < 0) {
+    kopt_next_call(_kopt,
+                   _from_x, _from_y, _from_z,
+                   _from_x, _from_y, _from_z - 1,
+                   _to_x, _to_y, _to_z,
+                   _depth, _total_cost);
+  }
+
+  // Y移動（プラス方向）
+  delta_y = _to_y - _from_y;
+  if(delta_y > 0) {
+    kopt_next_call(_kopt,
+                   _from_x, _from_y, _from_z,
+                   _from_x, _from_y + 1, _from_z,
+                   _to_x, _to_y, _to_z,
+                   _depth, _total_cost);
+  }
+  // Y移動（マイナス方向）
+  else if(delta_y < 0) {
+    kopt_next_call(_kopt,
+                   _from_x, _from_y, _from_z,
+                   _from_x, _from_y - 1, _from_z,
+                   _to_x, _to_y, _to_z,
+                   _depth, _total_cost);
+  }
+
+  // X移動（プラス方向）
+  delta_x = _to_x - _from_x;
+  if(delta_x > 0) {
+    kopt_next_call(_kopt,
+                   _from_x, _from_y, _from_z,
+                   _from_x + 1, _from_y, _from_z,
+                   _to_x, _to_y, _to_z,
+                   _depth, _total_cost);
+  }
+  // X移動（マイナス方向）
+  else if(delta_x < 0) {
+    kopt_next_call(_kopt,
+                   _from_x, _from_y, _from_z,
+                   _from_x - 1, _from_y, _from_z,
+                   _to_x, _to_y, _to_z,
+                   _depth, _total_cost);
+  }
+}
+
+//////////////////////////////
+// オブジェクトNo.を指定して順路探索（全方向）
+//////////////////////////////
+static void search_route_by_object_no_multi_way(kopt_t* const _kopt, int const _object_no) {
+  object_t const* obj;
+
+  // 発電機と装置をつなぐ順路探索
+  obj = _kopt->object_list + _object_no;
+  search_route_by_kopt_multi_way(_kopt,
+                                 obj->gen.x, obj->gen.y, obj->gen.z,
+                                 obj->equ.x, obj->equ.y, obj->equ.z);
+}
+
+//////////////////////////////
+// K-OPT 順路探索
+//////////////////////////////
+static void search_route_by_kopt_multi_way(kopt_t* const _kopt,
+                                           int const _from_x, int const _from_y, int const _from_z,
+                                           int const _to_x, int const _to_y, int const _to_z) {
+  // 順路探索
+  _kopt->best_cost = INT_MAX;
+  _kopt->candidate_size = 0;
+  kopt_multi_way_local_search(_kopt,
+                              _from_x, _from_y, _from_z,
+                              _to_x, _to_y, _to_z,
+                              1, 0);
+  // 候補経路を残した場合は、その中から選ぶ
+  if(_kopt->candidate_max > 1) {
+    kopt_candidate_select(_kopt);
+  }
+  // 順路が見つかった場合
+  if(_kopt->best_cost < INT_MAX) {
+    kopt_link_best(_kopt);
+  }
+}
+
+//////////////////////////////
+// K-OPT 局所的な順路探索（全方向）
+//////////////////////////////
+static void kopt_multi_way_local_search(kopt_t* const _kopt,
+                                        int const _from_x, int const _from_y, int const _from_z,
+                                        int const _to_x, int const _to_y, int const _to_z,
+                                        int const _depth, int const _total_cost) {
+  // 順路が目的地点に到達した場合、記録更新
+  if(_from_x == _to_x && _from_y == _to_y && _from_z == _to_z) {
+    kopt_best_judge(_kopt, _from_x, _from_y, _from_z, _total_cost);
+    return;
+  }
+  // Z移動（プラス方向）
+  if(_from_z + 1 < SCALE_SIZE) {
+    kopt_next_call(_kopt,
+                   _from_x, _from_y, _from_z,
+                   _from_x, _from_y, _from_z + 1,
+                   _to_x, _to_y, _to_z,
+                   _depth, _total_cost);
+  }
+  // Z移動（マイナス方向）
+  if(_from_z - 1 >= 0) {
+    kopt_next_call(_kopt,
+                   _from_x, _from_y, _from_z,
+                   _from_x, _from_y, _from_z - 1,
+                   _to_x, _to_y, _to_z,
+                   _depth, _total_cost);
+  }
+
+  // Y移動（プラス方向）
+  if(_from_y + 1 < SCALE_SIZE) {
+    kopt_next_call(_kopt,
+                   _from_x, _from_y, _from_z,
+                   _from_x, _from_y + 1, _from_z,
+                   _to_x, _to_y, _to_z,
+                   _depth, _total_cost);
+  }
+  // Y移動（マイナス方向）
+  if(_from_y - 1 >= 0) {
+    kopt_next_call(_kopt,
+                   _from_x, _from_y, _from_z,
+                   _from_x, _from_y - 1, _from_z,
+                   _to_x, _to_y, _to_z,
+                   _depth, _total_cost);
+  }
+
+  // X移動（プラス方向）
+  if(_from_x + 1 < SCALE_SIZE) {
+    kopt_next_call(_kopt,
+                   _from_x, _from_y, _from_z,
+                   _from_x + 1, _from_y, _from_z,
+                   _to_x, _to_y, _to_z,
+                   _depth, _total_cost);
+  }
+  // X移動（マイナス方向）
+  if(_from_x - 1 >= 0) {
+    kopt_next_call(_kopt,
+                   _from_x, _from_y, _from_z,
+                   _from_x - 1, _from_y, _from_z,
+                   _to_x, _to_y, _to_z,
+                   _depth, _total_cost);
+  }
+}
+
+//////////////////////////////
+// K-OPT 次の順路探索
+//////////////////////////////
+static void kopt_next_call(kopt_t* const _kopt,
+                           int const _from_x, int const _from_y, int const _from_z,
+                           int const _next_x, int const _next_y, int const _next_z,
+                           int const _to_x, int const _to_y, int const _to_z,
+                           int const _depth, int const _total_cost) {
+  int index_from, index_next, cost;
+  route_t* rt_from;
+  route_t* rt_next;
+
+  // 次の順路が到達可能なら次を探す
+  index_next = INDEX(_next_x, _next_y, _next_z);
+  rt_next = _kopt->route_list + index_next;
+  // 回廊が指定されている場合は、回廊の外には出ない
+  if(!IN_CORRIDOR(_kopt, index_next)) {
+    return;
+  }
+  if(IS_OPEN(rt_next)) {
+    // 既に順路構築不可能な座標の場合は、優先順位を上げる
+    cost = kopt_cell_cost(_kopt, index_next);
+    // コストは増える一方なので、最小コストに届いた時点で打ち切る（結果は変わらない）
+    if(_total_cost + cost >= _kopt->best_cost) {
+      return;
+    }
+    // 順路の紐付け
+    index_from = INDEX(_from_x, _from_y, _from_z);
+    rt_from = _kopt->route_list + index_from;
+    rt_from->next = index_next;
+    rt_next->prev = index_from;
+    // 次の順路探索
+    kopt_local_search(_kopt,
+                      _next_x, _next_y, _next_z,
+                      _to_x, _to_y, _to_z,
+                      _depth + 1, _total_cost + cost);
+    // 順路の紐付け削除
+    rt_from->next = -1;
+    rt_next->prev = -1;
+  }
+}
+
+//////////////////////////////
+// K-OPT 記録判定と更新
+//////////////////////////////
+static void kopt_best_judge(kopt_t* const _kopt, int const _x, int const _y, int const _z,
+                            int const _total_cost) {
+  int i, index;
+
+  // 候補経路を複数残す場合
+  if(_kopt->candidate_max > 1) {
+    kopt_candidate_add(_kopt, INDEX(_x, _y, _z), _total_cost);
+    return;
+  }
+  // 最低コストが見つかった場合は、記録更新
+  if(_total_cost < _kopt->best_cost) {
+    _kopt->best_cost = _total_cost;
+    i = 0;
+    index = INDEX(_x, _y, _z);
+    while (index != -1) {
+      _kopt->best_route[i] = index;
+      ++ i;
+      index = (_kopt->route_list + index)->prev;
+    }
+    _kopt->best_route[i] = -1;
+  }
+}
+
+//////////////////////////////
+// K-OPT 最小コストの順路を紐付け
+//////////////////////////////
+static void kopt_link_best(kopt_t* const _kopt) {
+  int* index_curr;
+  int* index_prev;
+  route_t* rt_curr;
+  route_t* rt_prev;
+
+  // 順路を逆から構築
+  index_curr = _kopt->best_route;
+  index_prev = _kopt->best_route + 1;
+  while(*index_prev != -1) {
+    rt_curr = _kopt->route_list + *index_curr;
+    rt_prev = _kopt->route_list + *index_prev;
+    rt_curr->prev = *index_prev;
+    rt_prev->next = *index_curr;
+    ++ index_curr;
+    ++ index_prev;
+  }
+}
+
+//////////////////////////////
+// K-OPT 候補経路をコスト順に加える（候補がそろったら、最も高いコストで探索を打ち切る）
+//////////////////////////////
+static void kopt_candidate_add(kopt_t* const _kopt, int const _index, int const _total_cost) {
+  int i, n, index;
+
+  if(_total_cost >= _kopt->best_cost) {
+    return;
+  }
+  // 挿入位置（あふれた候補は捨てる）
+  n = _kopt->candidate_size < _kopt->candidate_max ? _kopt->candidate_size : _kopt->candidate_max - 1;
+  for(; n > 0 && _kopt->candidate_cost[n - 1] > _total_cost; -- n) {
+    _kopt->candidate_cost[n] = _kopt->candidate_cost[n - 1];
+    memcpy(_kopt->candidate_route[n], _kopt->candidate_route[n - 1], sizeof(int) * ROUTE_SIZE);
+  }
+  _kopt->candidate_cost[n] = _total_cost;
+  i = 0;
+  for(index = _index; index != -1; index = (_kopt->route_list + index)->prev) {
+    _kopt->candidate_route[n][i] = index;
+    ++ i;
+  }
+  _kopt->candidate_route[n][i] = -1;
+  if(_kopt->candidate_size < _kopt->candidate_max) {
+    ++ _kopt->candidate_size;
+  }
+  if(_kopt->candidate_size == _kopt->candidate_max) {
+    _kopt->best_cost = _kopt->candidate_cost[_kopt->candidate_max - 1];
+  }
+}
+
+//////////////////////////////
+// K-OPT 候補経路から、閉じ込めるペアのコストを足して最小のものを選ぶ
+//////////////////////////////
+static void kopt_candidate_select(kopt_t* const _kopt) {
+  int i, best, score, best_score;
+
+  _kopt->best_cost = INT_MAX;
+  if(_kopt->candidate_size == 0) {
+    return;
+  }
+  best = 0;
+  if(_kopt->candidate_size > 1) {
+    // 印があふれる前に消す（候補ごとに、隣の部屋の数の2倍まで印を使う）
+    if(_kopt->connect->stamp > INT_MAX - CONNECT_CANDIDATE_MAX * (ROUTE_SIZE * 12 + 1) - 1) {
+      memset(_kopt->connect, 0, sizeof(connect_t));
+    }
+    _kopt->connect->select = ++ _kopt->connect->stamp;
+    best_score = INT_MAX;
+    // コスト順なので、コストだけで最良に届いたら以降は見ない
+    for(i = 0; i < _kopt->candidate_size && _kopt->candidate_cost[i] < best_score; ++ i) {
+      score = _kopt->candidate_cost[i]
+            + connect_seal_cost(_kopt, _kopt->candidate_route[i], best_score - _kopt->candidate_cost[i]);
+      if(score < best_score) {
+        best_score = score;
+        best = i;
+      }
+    }
+  }
+  _kopt->best_cost = _kopt->candidate_cost[best];
+  memcpy(_kopt->best_route, _kopt->candidate_route[best], sizeof(int) * ROUTE_SIZE);
+}
+
+//////////////////////////////
+// 経路に隣り合う、まだつなげられるペアのうち、経路を置くとつながらなくなるペアのコストの合計
+// （置く前からつながっていないペアは数えない、_limit に達したらそこで打ち切る）
+//////////////////////////////
+static int connect_seal_cost(kopt_t* const _kopt, int const* const _route, int const _limit) {
+  static int const delta[6][3] = {
+    {0, 0, 1}, {0, 0, -1}, {0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {-1, 0, 0}
+  };
+  int i, k, x, y, z, index, object_no, block, total;
+  connect_t* connect;
+  object_t const* obj;
+  xyz_t const* xyz;
+
+  connect = _kopt->connect;
+  block = ++ connect->stamp;
+  for(i = 0; _route[i] != -1; ++ i) {
+    connect->block[_route[i]] = block;
+  }
+  total = 0;
+  for(i = 0; _route[i] != -1; ++ i) {
+    xyz = &(_kopt->route_list + _route[i])->coord;
+    for(k = 0; k < 6; ++ k) {
+      x = xyz->x + delta[k][0];
+      y = xyz->y + delta[k][1];
+      z = xyz->z + delta[k][2];
+      if(x < 0 || SCALE_SIZE <= x || y < 0 || SCALE_SIZE <= y || z < 0 || SCALE_SIZE <= z) {
+        continue;
+      }
+      index = INDEX(x, y, z);
+      object_no = _kopt->object_no_list[index];
+      if(connect->block[index] == block || object_no == -1 || connect->object[object_no] == block) {
+        continue;
+      }
+      connect->object[object_no] = block;
+      // 両端が空いていて、経路にも使われないペアだけを調べる
+      obj = _kopt->object_list + object_no;
+      index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+      if(!IS_OPEN(_kopt->route_list + index) || connect->block[index] == block) {
+        continue;
+      }
+      index = INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
+      if(!IS_OPEN(_kopt->route_list + index) || connect->block[index] == block) {
+        continue;
+      }
+      // 置く前のつながりは、候補経路によらないのでペアごとに1回だけ調べる
+      if(connect->before[object_no] != connect->select) {
+        connect->before[object_no] = connect->select;
+        connect->reach[object_no] = (unsigned char)connect_reach(_kopt, obj, -1);
+      }
+      if(connect->reach[object_no] && !connect_reach(_kopt, obj, block)) {
+        total += obj->cost;
+        if(total >= _limit) {
+          return total;
+        }
+      }
+    }
+  }
+  return total;
+}
+
+//////////////////////////////
+// ペアの両端が空き部屋でつながっているか（幅優先探索、_block の印の部屋は通らない、-1 なら印を見ない）
+// 順路探索が通る範囲（両端を囲む箱を1部屋広げたもの）だけを調べ、
+// CONNECT_NODE_MAX 部屋を超えたらつながっているとみなす
+//////////////////////////////
+static int connect_reach(kopt_t* const _kopt, object_t const* const _obj, int const _block) {
+  static int const delta[6][3] = {
+    {0, 0, 1}, {0, 0, -1}, {0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {-1, 0, 0}
+  };
+  int k, x, y, z, index, target, head, tail, visit;
+  int lo[3], hi[3];
+  connect_t* connect;
+  xyz_t const* xyz;
+
+  connect = _kopt->connect;
+  search_box(_obj, lo, hi);
+  target = INDEX(_obj->equ.x, _obj->equ.y, _obj->equ.z);
+  visit = ++ connect->stamp;
+  index = INDEX(_obj->gen.x, _obj->gen.y, _obj->gen.z);
+  connect->visit[index] = visit;
+  connect->queue[0] = index;
+  head = 0;
+  tail = 1;
+  while(head < tail) {
+    xyz = &(_kopt->route_list + connect->queue[head])->coord;
+    ++ head;
+    for(k = 0; k < 6; ++ k) {
+      x = xyz->x + delta[k][0];
+      y = xyz->y + delta[k][1];
+      z = xyz->z + delta[k][2];
+      if(x < lo[0] || hi[0] < x || y < lo[1] || hi[1] < y || z < lo[2] || hi[2] < z
+      || x < 0 || SCALE_SIZE <= x || y < 0 || SCALE_SIZE <= y || z < 0 || SCALE_SIZE <= z) {
+        continue;
+      }
+      index = INDEX(x, y, z);
+      if(index == target) {
+        return 1;
+      }
+      if(connect->visit[index] == visit || connect->block[index] == _block
+      || !IS_OPEN(_kopt->route_list + index)) {
+        continue;
+      }
+      // 調べきれないほど広ければ、閉じ込めていないとみなす
+      if(tail == CONNECT_NODE_MAX) {
+        return 1;
+      }
+      connect->visit[index] = visit;
+      connect->queue[tail] = index;
+      ++ tail;
+    }
+  }
+  return 0;
+}
+
+//////////////////////////////
+// K-OPT 部屋を通るコスト（まだつなげられるペアの部屋ならそのペアのコスト）
+//////////////////////////////
+static int kopt_cell_cost(kopt_t const* const _kopt, int const _index) {
+  int object_no;
+  route_t const* rt_gen;
+  route_t const* rt_equ;
+  object_t const* obj;
+
+  // オブジェクトが置かれていない部屋はコスト無し
+  object_no = _kopt->object_no_list[_index];
+  if(object_no == -1) {
+    return 0;
+  }
+  obj = _kopt->object_list + object_no;
+  // 並列探索中は、領域外の部屋は他のワーカーが書き換えるので開始時の状態を見る
+  if(_kopt->open_snapshot != NULL) {
+    if(kopt_is_open(_kopt, &obj->gen) && kopt_is_open(_kopt, &obj->equ)) {
+      return obj->cost;
+    }
+    return 0;
+  }
+  rt_gen = _kopt->route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+  rt_equ = _kopt->route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
+  // 次の座標がまだ有効かどうか
+  if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+    return obj->cost;
+  }
+  return 0;
+}
+
+//////////////////////////////
+// K-OPT 部屋が空いているか（並列探索中の領域外は開始時の状態）
+//////////////////////////////
+static int kopt_is_open(kopt_t const* const _kopt, xyz_t const* const _xyz) {
+  int index;
+
+  index = INDEX(_xyz->x, _xyz->y, _xyz->z);
+  if(_xyz->x < _kopt->region_begin.x || _kopt->region_end.x <= _xyz->x
+  || _xyz->y < _kopt->region_begin.y || _kopt->region_end.y <= _xyz->y
+  || _xyz->z < _kopt->region_begin.z || _kopt->region_end.z <= _xyz->z) {
+    return _kopt->open_snapshot[index];
+  }
+  return IS_OPEN(_kopt->route_list + index);
+}
+
+//////////////////////////////
+// タイルリスト初期化
+//////////////////////////////
+static int init_tile_list(vigne_solver_t* const _solver) {
+  int x, y, z, tile_size, tile_scale, tile_count, index, tile;
+
+  // 既に確保済みで同じ大きさなら使い回す
+  tile_size = _solver->config.tile_size;
+  if(tile_size <= 0 || tile_size == _solver->tile_size) {
+    return 0;
+  }
+  free_tile_list(_solver);
+  tile_scale = (SCALE_SIZE + tile_size - 1) / tile_size;
+  tile_count = tile_scale * tile_scale * tile_scale;
+  // メモリ確保
+  _solver->cell_tile = (int*)malloc(sizeof(int) * VIGNE_CELL_SIZE);
+  _solver->tile_capacity = (int*)malloc(sizeof(int) * tile_count);
+  _solver->tile_usage = (int*)malloc(sizeof(int) * tile_count);
+  _solver->tile_mark = (int*)malloc(sizeof(int) * tile_count);
+  _solver->tile_cost = (int*)malloc(sizeof(int) * tile_count);
+  _solver->tile_from = (int*)malloc(sizeof(int) * tile_count);
+  _solver->corridor_head = (int*)malloc(sizeof(int) * (OBJECT_SIZE + 1));
+  _solver->corridor_list = (int*)malloc(sizeof(int) * OBJECT_SIZE * (tile_scale * 3 + 1));
+  if(_solver->cell_tile == NULL || _solver->tile_capacity == NULL || _solver->tile_usage == NULL
+  || _solver->tile_mark == NULL || _solver->tile_cost == NULL || _solver->tile_from == NULL
+  || _solver->corridor_head == NULL || _solver->corridor_list == NULL) {
+    free_tile_list(_solver);
+    return -1;
+  }
+  _solver->tile_size = tile_size;
+  _solver->tile_scale = tile_scale;
+  _solver->tile_stamp = 0;
+  // 部屋とタイルの対応、タイルの容量（部屋数）
+  memset(_solver->cell_tile, 0, sizeof(int) * VIGNE_CELL_SIZE);
+  memset(_solver->tile_capacity, 0, sizeof(int) * tile_count);
+  memset(_solver->tile_mark, 0, sizeof(int) * tile_count);
+  for(x = 0; x < SCALE_SIZE; ++ x) {
+    for(y = 0; y < SCALE_SIZE; ++ y) {
+      for(z = 0; z < SCALE_SIZE; ++ z) {
+        index = INDEX(x, y, z);
+        tile = TILE_INDEX(tile_scale, x / tile_size, y / tile_size, z / tile_size);
+        _solver->cell_tile[index] = tile;
+        ++ _solver->tile_capacity[tile];
+      }
+    }
+  }
+  return 0;
+}
+
+//////////////////////////////
+// タイルリスト開放
+//////////////////////////////
+static void free_tile_list(vigne_solver_t* const _solver) {
+  free(_solver->cell_tile);
+  free(_solver->tile_capacity);
+  free(_solver->tile_usage);
+  free(_solver->tile_mark);
+  free(_solver->tile_cost);
+  free(_solver->tile_from);
+  free(_solver->corridor_head);
+  free(_solver->corridor_list);
+  _solver->cell_tile = NULL;
+  _solver->tile_capacity = NULL;
+  _solver->tile_usage = NULL;
+  _solver->tile_mark = NULL;
+  _solver->tile_cost = NULL;
+  _solver->tile_from = NULL;
+  _solver->corridor_head = NULL;
+  _solver->corridor_list = NULL;
+  _solver->tile_size = 0;
+  _solver->tile_scale = 0;
+}
+
+//////////////////////////////
+// 階層順路探索
+//////////////////////////////
+static void search_route_by_tile(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                                 route_t* const _route_list) {
+  int i, j, size, tile_count;
+  object_t const* obj;
+  route_t* rt_gen;
+  route_t* rt_equ;
+  kopt_t kopt;
+
+  // タイルの使用量（既に順路が通っている部屋の数）
+  tile_count = _solver->tile_scale * _solver->tile_scale * _solver->tile_scale;
+  memset(_solver->tile_usage, 0, sizeof(int) * tile_count);
+  for(i = 0; i < VIGNE_CELL_SIZE; ++ i) {
+    if(IS_CLOSE(_route_list + i)) {
+      ++ _solver->tile_usage[_solver->cell_tile[i]];
+    }
+  }
+  // 粗い探索（コストが高い順に、つなげられる全ペアの回廊をタイル単位で決める）
+  size = 0;
+  for(i = 0; i < _solver->cost_size; ++ i) {
+    _solver->corridor_head[i] = size;
+    obj = _solver->object_list + _cost_list[i].key;
+    rt_gen = _route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    rt_equ = _route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
+    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+      size += tile_route(_solver, obj, _solver->corridor_list + size);
+    }
+  }
+  _solver->corridor_head[_solver->cost_size] = size;
+
+  // 詳細な探索（回廊の中だけを DP で探索するので、1ペアの手間は回廊の大きさで決まる）
+  init_kopt(&kopt, _solver, _route_list);
+  kopt.tile_mark = _solver->tile_mark;
+  for(i = 0; i < _solver->cost_size; ++ i) {
+    if(_solver->corridor_head[i] == _solver->corridor_head[i + 1]) {
+      continue;
+    }
+    obj = _solver->object_list + _cost_list[i].key;
+    rt_gen = _route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    rt_equ = _route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
+    // 回廊に印を付ける
+    kopt.tile_stamp = ++ _solver->tile_stamp;
+    for(j = _solver->corridor_head[i]; j < _solver->corridor_head[i + 1]; ++ j) {
+      _solver->tile_mark[_solver->corridor_list[j]] = kopt.tile_stamp;
+    }
+    // 単方向探索
+    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+      search_route_by_dp(&kopt, _cost_list[i].key);
+    }
+    // 全方向探索
+    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+      search_route_by_dp_multi_way(&kopt, _cost_list[i].key);
+    }
+    // 見つからなければ、回廊を隣のタイルまで広げてもう一度だけ探す
+    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+      kopt.tile_stamp = ++ _solver->tile_stamp;
+      for(j = _solver->corridor_head[i]; j < _solver->corridor_head[i + 1]; ++ j) {
+        tile_mark_around(_solver, _solver->corridor_list[j], kopt.tile_stamp);
+      }
+      search_route_by_dp(&kopt, _cost_list[i].key);
+      if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+        search_route_by_dp_multi_way(&kopt, _cost_list[i].key);
+      }
+    }
+  }
+}
+
+//////////////////////////////
+// タイル単位の経路探索（単方向、使用量が少ないタイルを選ぶ）
+//////////////////////////////
+static int tile_route(vigne_solver_t* const _solver, object_t const* const _obj,
+                      int* const _tile_list) {
+  int gen_x, gen_y, gen_z, sign_x, sign_y, sign_z, size_x, size_y, size_z;
+  int dx, dy, dz, local, from, best, tile, size, tile_size, tile_scale;
+
+  tile_size = _solver->tile_size;
+  tile_scale = _solver->tile_scale;
+  // 発電機と装置のタイル
+  gen_x = _obj->gen.x / tile_size;
+  gen_y = _obj->gen.y / tile_size;
+  gen_z = _obj->gen.z / tile_size;
+  sign_x = _obj->equ.x / tile_size >= gen_x ? 1 : -1;
+  sign_y = _obj->equ.y / tile_size >= gen_y ? 1 : -1;
+  sign_z = _obj->equ.z / tile_size >= gen_z ? 1 : -1;
+  size_x = abs(_obj->equ.x / tile_size - gen_x) + 1;
+  size_y = abs(_obj->equ.y / tile_size - gen_y) + 1;
+  size_z = abs(_obj->equ.z / tile_size - gen_z) + 1;
+  // 発電機のタイルから近い順にコストを確定する（DP）
+  for(dx = 0; dx < size_x; ++ dx) {
+    for(dy = 0; dy < size_y; ++ dy) {
+      for(dz = 0; dz < size_z; ++ dz) {
+        local = (dx * size_y + dy) * size_z + dz;
+        best = 0;
+        from = -1;
+        if(dx > 0 || dy > 0 || dz > 0) {
+          best = INT_MAX;
+          if(dx > 0 && _solver->tile_cost[local - size_y * size_z] < best) {
+            best = _solver->tile_cost[local - size_y * size_z];
+            from = local - size_y * size_z;
+          }
+          if(dy > 0 && _solver->tile_cost[local - size_z] < best) {
+            best = _solver->tile_cost[local - size_z];
+            from = local - size_z;
+          }
+          if(dz > 0 && _solver->tile_cost[local - 1] < best) {
+            best = _solver->tile_cost[local - 1];
+            from = local - 1;
+          }
+        }
+        tile = TILE_INDEX(tile_scale, gen_x + sign_x * dx, gen_y + sign_y * dy, gen_z + sign_z * dz);
+        _solver->tile_cost[local] = best + tile_cost(_solver, tile);
+        _solver->tile_from[local] = from;
+      }
+    }
+  }
+  // 装置のタイルから逆に辿って回廊を記録し、使用量を見積もる
+  size = 0;
+  local = size_x * size_y * size_z - 1;
+  while(local != -1) {
+    dx = local / (size_y * size_z);
+    dy = (local / size_z) % size_y;
+    dz = local % size_z;
+    tile = TILE_INDEX(tile_scale, gen_x + sign_x * dx, gen_y + sign_y * dy, gen_z + sign_z * dz);
+    _tile_list[size] = tile;
+    ++ size;
+    _solver->tile_usage[tile] += tile_size;
+    local = _solver->tile_from[local];
+  }
+  return size;
+}
+
+//////////////////////////////
+// 回廊内の順路探索（単方向）
+//////////////////////////////
+static void search_route_by_dp(kopt_t* const _kopt, int const _object_no) {
+  object_t const* obj;
+
+  // 発電機と装置をつなぐ順路探索
+  obj = _kopt->object_list + _object_no;
+  _kopt->best_cost = kopt_dp_search(_kopt,
+                                    obj->gen.x, obj->gen.y, obj->gen.z,
+                                    obj->equ.x, obj->equ.y, obj->equ.z,
+                                    -1, 0, _kopt->best_route);
+  // 順路が見つかった場合
+  if(_kopt->best_cost < INT_MAX) {
+    kopt_link_best(_kopt);
+  }
+}
+
+//////////////////////////////
+// 回廊内の順路探索（最初の1歩だけ全方向）
+//////////////////////////////
+static void search_route_by_dp_multi_way(kopt_t* const _kopt, int const _object_no) {
+  static int const delta[6][3] = {
+    {0, 0, 1}, {0, 0, -1}, {0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {-1, 0, 0}
+  };
+  int route[ROUTE_SIZE];
+  int i, j, x, y, z, index, index_gen, cost;
+  object_t const* obj;
+
+  obj = _kopt->object_list + _object_no;
+  index_gen = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+  _kopt->best_cost = INT_MAX;
+  for(i = 0; i < 6; ++ i) {
+    x = obj->gen.x + delta[i][0];
+    y = obj->gen.y + delta[i][1];
+    z = obj->gen.z + delta[i][2];
+    if(x < 0 || SCALE_SIZE <= x || y < 0 || SCALE_SIZE <= y || z < 0 || SCALE_SIZE <= z) {
+      continue;
+    }
+    // 最初の1歩の部屋から装置まで（発電機の部屋は通らない）
+    index = INDEX(x, y, z);
+    if(!IS_OPEN(_kopt->route_list + index) || !IN_CORRIDOR(_kopt, index)) {
+      continue;
+    }
+    cost = kopt_dp_search(_kopt, x, y, z, obj->equ.x, obj->equ.y, obj->equ.z, index_gen, 0, route);
+    if(cost < INT_MAX && cost + kopt_cell_cost(_kopt, index) < _kopt->best_cost) {
+      _kopt->best_cost = cost + kopt_cell_cost(_kopt, index);
+      for(j = 0; route[j] != -1; ++ j) {
+        _kopt->best_route[j] = route[j];
+      }
+      _kopt->best_route[j] = index_gen;
+      _kopt->best_route[j + 1] = -1;
+    }
+  }
+  // 順路が見つかった場合
+  if(_kopt->best_cost < INT_MAX) {
+    kopt_link_best(_kopt);
+  }
+}
+
+//////////////////////////////
+// 回廊内の最小コスト経路（単方向なので DP で求まる）
+// _penalty が 0 なら使用中の部屋は通らず、正なら使用中の部屋をそのコストで通る
+//////////////////////////////
+static int kopt_dp_search(kopt_t* const _kopt,
+                          int const _from_x, int const _from_y, int const _from_z,
+                          int const _to_x, int const _to_y, int const _to_z,
+                          int const _block_index, int const _penalty, int* const _route) {
+  int sign_x, sign_y, sign_z, size_x, size_y, size_z;
+  int dx, dy, dz, local, index, best, from, size, cost;
+
+  sign_x = _to_x >= _from_x ? 1 : -1;
+  sign_y = _to_y >= _from_y ? 1 : -1;
+  sign_z = _to_z >= _from_z ? 1 : -1;
+  size_x = abs(_to_x - _from_x) + 1;
+  size_y = abs(_to_y - _from_y) + 1;
+  size_z = abs(_to_z - _from_z) + 1;
+  // 出発点から近い順にコストを確定する
+  // （1つのペアの両端を通るとコストを2回数えるが、DFS と違ってそこは区別しない）
+  for(dx = 0; dx < size_x; ++ dx) {
+    for(dy = 0; dy < size_y; ++ dy) {
+      for(dz = 0; dz < size_z; ++ dz) {
+        local = (dx * size_y + dy) * size_z + dz;
+        index = INDEX(_from_x + sign_x * dx, _from_y + sign_y * dy, _from_z + sign_z * dz);
+        _kopt->dp_from[local] = -1;
+        if(local == 0) {
+          _kopt->dp_cost[local] = 0;
+          continue;
+        }
+        _kopt->dp_cost[local] = INT_MAX;
+        // 使用中・回廊の外・通行禁止の部屋は通らない
+        if((_penalty == 0 && !IS_OPEN(_kopt->route_list + index)) || index == _block_index
+        || !IN_CORRIDOR(_kopt, index)) {
+          continue;
+        }
+        best = INT_MAX;
+        from = -1;
+        if(dx > 0 && _kopt->dp_cost[local - size_y * size_z] < best) {
+          best = _kopt->dp_cost[local - size_y * size_z];
+          from = local - size_y * size_z;
+        }
+        if(dy > 0 && _kopt->dp_cost[local - size_z] < best) {
+          best = _kopt->dp_cost[local - size_z];
+          from = local - size_z;
+        }
+        if(dz > 0 && _kopt->dp_cost[local - 1] < best) {
+          best = _kopt->dp_cost[local - 1];
+          from = local - 1;
+        }
+        if(from != -1) {
+          cost = IS_OPEN(_kopt->route_list + index) ? kopt_cell_cost(_kopt, index) : _penalty;
+          _kopt->dp_cost[local] = best + cost;
+          _kopt->dp_from[local] = from;
+        }
+      }
+    }
+  }
+  // 到達できなければ終わり
+  local = size_x * size_y * size_z - 1;
+  if(_kopt->dp_cost[local] == INT_MAX) {
+    return INT_MAX;
+  }
+  // 到達点から逆に辿って順路を記録
+  size = 0;
+  best = _kopt->dp_cost[local];
+  while(local != -1) {
+    dx = local / (size_y * size_z);
+    dy = (local / size_z) % size_y;
+    dz = local % size_z;
+    _route[size] = INDEX(_from_x + sign_x * dx, _from_y + sign_y * dy, _from_z + sign_z * dz);
+    ++ size;
+    local = _kopt->dp_from[local];
+  }
+  _route[size] = -1;
+  return best;
+}
+
+//////////////////////////////
+// タイルを通るコスト（混んでいるタイルほど高い）
+//////////////////////////////
+static int tile_cost(vigne_solver_t const* const _solver, int const _tile) {
+  int usage, capacity;
+
+  usage = _solver->tile_usage[_tile];
+  capacity = _solver->tile_capacity[_tile];
+  if(usage >= capacity) {
+    return TILE_COST_BASE + TILE_COST_WEIGHT + TILE_COST_FULL;
+  }
+  return TILE_COST_BASE + TILE_COST_WEIGHT * usage / capacity;
+}
+
+//////////////////////////////
+// タイルとその隣（6方向）に印を付ける
+//////////////////////////////
+static void tile_mark_around(vigne_solver_t* const _solver, int const _tile, int const _stamp) {
+  int tile_scale, tx, ty, tz;
+
+  tile_scale = _solver->tile_scale;
+  tx = _tile / (tile_scale * tile_scale);
+  ty = (_tile / tile_scale) % tile_scale;
+  tz = _tile % tile_scale;
+  _solver->tile_mark[_tile] = _stamp;
+  if(tx + 1 < tile_scale) {
+    _solver->tile_mark[TILE_INDEX(tile_scale, tx + 1, ty, tz)] = _stamp;
+  }
+  if(tx - 1 >= 0) {
+    _solver->tile_mark[TILE_INDEX(tile_scale, tx - 1, ty, tz)] = _stamp;
+  }
+  if(ty + 1 < tile_scale) {
+    _solver->tile_mark[TILE_INDEX(tile_scale, tx, ty + 1, tz)] = _stamp;
+  }
+  if(ty - 1 >= 0) {
+    _solver->tile_mark[TILE_INDEX(tile_scale, tx, ty - 1, tz)] = _stamp;
+  }
+  if(tz + 1 < tile_scale) {
+    _solver->tile_mark[TILE_INDEX(tile_scale, tx, ty, tz + 1)] = _stamp;
+  }
+  if(tz - 1 >= 0) {
+    _solver->tile_mark[TILE_INDEX(tile_scale, tx, ty, tz - 1)] = _stamp;
+  }
+}
+
+//////////////////////////////
+// 領域リスト初期化
+//////////////////////////////
+static int init_region_list(vigne_solver_t* const _solver) {
+  int i, k, region_size, region_scale, region_count, worker_size;
+  int lo[3], hi[3], r[3];
+  object_t const* obj;
+
+  free_region_list(_solver);
+  region_size = _solver->config.region_size;
+  worker_size = _solver->config.threads;
+  if(worker_size <= 1 || region_size <= 0) {
+    return 0;
+  }
+  if(worker_size > REGION_THREAD_MAX) {
+    worker_size = REGION_THREAD_MAX;
+  }
+  region_scale = (SCALE_SIZE + region_size - 1) / region_size;
+  region_count = region_scale * region_scale * region_scale;
+  // メモリ確保
+  _solver->object_region = (int*)malloc(sizeof(int) * OBJECT_SIZE);
+  _solver->region_head = (int*)malloc(sizeof(int) * (region_count + 1));
+  _solver->region_list = (int*)malloc(sizeof(int) * OBJECT_SIZE);
+  _solver->open_snapshot = (unsigned char*)malloc(sizeof(unsigned char) * VIGNE_CELL_SIZE);
+  _solver->deque_list = (deque_t*)malloc(sizeof(deque_t) * worker_size);
+  if(_solver->object_region == NULL || _solver->region_head == NULL || _solver->region_list == NULL
+  || _solver->open_snapshot == NULL || _solver->deque_list == NULL) {
+    free(_solver->deque_list);
+    _solver->deque_list = NULL;
+    free_region_list(_solver);
+    return -1;
+  }
+  for(i = 0; i < worker_size; ++ i) {
+    _solver->deque_list[i].list = (int*)malloc(sizeof(int) * region_count);
+    pthread_mutex_init(&_solver->deque_list[i].mutex, NULL);
+    _solver->worker_size = i + 1;
+    if(_solver->deque_list[i].list == NULL) {
+      free_region_list(_solver);
+      return -1;
+    }
+  }
+  _solver->region_size = region_size;
+  _solver->region_scale = region_scale;
+  // 探索範囲（全方向探索の1歩を含めて、両端を囲む箱を1部屋広げたもの）が収まる領域
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    obj = _solver->object_list + i;
+    search_box(obj, lo, hi);
+    _solver->object_region[i] = 0;
+    for(k = 0; k < 3; ++ k) {
+      lo[k] = lo[k] < 0 ? 0 : lo[k];
+      hi[k] = hi[k] >= SCALE_SIZE ? SCALE_SIZE - 1 : hi[k];
+      r[k] = lo[k] / region_size;
+      if(r[k] != hi[k] / region_size) {
+        _solver->object_region[i] = -1;
+      }
+    }
+    if(_solver->object_region[i] != -1) {
+      _solver->object_region[i] = TILE_INDEX(region_scale, r[0], r[1], r[2]);
+    }
+  }
+  return 0;
+}
+
+//////////////////////////////
+// 領域リスト開放
+//////////////////////////////
+static void free_region_list(vigne_solver_t* const _solver) {
+  int i;
+
+  for(i = 0; i < _solver->worker_size; ++ i) {
+    free(_solver->deque_list[i].list);
+    pthread_mutex_destroy(&_solver->deque_list[i].mutex);
+  }
+  free(_solver->object_region);
+  free(_solver->region_head);
+  free(_solver->region_list);
+  free(_solver->open_snapshot);
+  free(_solver->deque_list);
+  _solver->object_region = NULL;
+  _solver->region_head = NULL;
+  _solver->region_list = NULL;
+  _solver->open_snapshot = NULL;
+  _solver->deque_list = NULL;
+  _solver->region_size = 0;
+  _solver->region_scale = 0;
+  _solver->worker_size = 0;
+}
+
+//////////////////////////////
+// 領域ごとの並列探索
+//////////////////////////////
+static void search_route_by_region(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                                   route_t* const _route_list) {
+  int i, region, region_count;
+  object_t const* obj;
+  route_t* rt_gen;
+  route_t* rt_equ;
+  kopt_t kopt;
+  pthread_t thread_list[REGION_THREAD_MAX];
+  region_worker_t worker_list[REGION_THREAD_MAX];
+  deque_t* deque;
+
+  region_count = _solver->region_scale * _solver->region_scale * _solver->region_scale;
+  // 領域ごとにコストリストの順番のまま並べる（計数ソート）
+  memset(_solver->region_head, 0, sizeof(int) * (region_count + 1));
+  for(i = 0; i < _solver->cost_size; ++ i) {
+    region = _solver->object_region[_cost_list[i].key];
+    if(region != -1) {
+      ++ _solver->region_head[region + 1];
+    }
+  }
+  for(i = 0; i < region_count; ++ i) {
+    _solver->region_head[i + 1] += _solver->region_head[i];
+  }
+  for(i = 0; i < _solver->cost_size; ++ i) {
+    region = _solver->object_region[_cost_list[i].key];
+    if(region != -1) {
+      _solver->region_list[_solver->region_head[region]] = i;
+      ++ _solver->region_head[region];
+    }
+  }
+  for(i = region_count; i > 0; -- i) {
+    _solver->region_head[i] = _solver->region_head[i - 1];
+  }
+  _solver->region_head[0] = 0;
+  // 開始時の部屋の空き状況（領域外の部屋のコストはこれで決める）
+  for(i = 0; i < VIGNE_CELL_SIZE; ++ i) {
+    _solver->open_snapshot[i] = IS_OPEN(_route_list + i);
+  }
+  // 領域をワーカーに順番に配る
+  for(i = 0; i < _solver->worker_size; ++ i) {
+    _solver->deque_list[i].head = 0;
+    _solver->deque_list[i].tail = 0;
+  }
+  for(i = 0; i < region_count; ++ i) {
+    if(_solver->region_head[i] == _solver->region_head[i + 1]) {
+      continue;
+    }
+    deque = _solver->deque_list + i % _solver->worker_size;
+    deque->list[deque->tail] = i;
+    ++ deque->tail;
+  }
+  // 並列探索（自分もワーカー0として働く）
+  for(i = 0; i < _solver->worker_size; ++ i) {
+    worker_list[i].solver = _solver;
+    worker_list[i].cost_list = _cost_list;
+    worker_list[i].route_list = _route_list;
+    worker_list[i].worker_no = i;
+    worker_list[i].worker_size = _solver->worker_size;
+  }
+  for(i = 1; i < _solver->worker_size; ++ i) {
+    if(pthread_create(thread_list + i, NULL, region_worker, worker_list + i) != 0) {
+      // 起動できなかったワーカーの分は、他のワーカーが盗んで探索する
+      worker_list[i].solver = NULL;
+    }
+  }
+  region_worker(worker_list);
+  for(i = 1; i < _solver->worker_size; ++ i) {
+    if(worker_list[i].solver != NULL) {
+      pthread_join(thread_list[i], NULL);
+    }
+  }
+  // 領域をまたぐペアは最後に順番に探索
+  init_kopt(&kopt, _solver, _route_list);
+  for(i = 0; i < _solver->cost_size; ++ i) {
+    if(_solver->object_region[_cost_list[i].key] != -1) {
+      continue;
+    }
+    obj = _solver->object_list + _cost_list[i].key;
+    rt_gen = _route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    rt_equ = _route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
+    // 単方向探索
+    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+      search_route_by_object_no(&kopt, _cost_list[i].key);
+    }
+    // 全方向探索
+    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+      search_route_by_object_no_multi_way(&kopt, _cost_list[i].key);
+    }
+  }
+}
+
+//////////////////////////////
+// 並列探索のワーカー
+//////////////////////////////
+static void* region_worker(void* _arg) {
+  region_worker_t* worker = (region_worker_t*)_arg;
+  int region;
+
+  // 探索する領域が無くなるまで、自分のキューから取り出すか他のワーカーから盗む
+  while((region = region_pop(worker->solver->deque_list, worker->worker_no, worker->worker_size)) != -1) {
+    search_route_in_region(worker->solver, worker->cost_list, worker->route_list, region);
+  }
+  return NULL;
+}
+
+//////////////////////////////
+// 次に探索する領域を取り出す（無ければ -1）
+//////////////////////////////
+static int region_pop(deque_t* const _deque_list, int const _worker_no, int const _worker_size) {
+  int i, region;
+  deque_t* deque;
+
+  // 自分のキューは末尾から
+  deque = _deque_list + _worker_no;
+  region = -1;
+  pthread_mutex_lock(&deque->mutex);
+  if(deque->head < deque->tail) {
+    -- deque->tail;
+    region = deque->list[deque->tail];
+  }
+  pthread_mutex_unlock(&deque->mutex);
+  // 他のワーカーのキューは先頭から盗む（領域は途中で増えないので、全て空なら終わり）
+  for(i = 1; region == -1 && i < _worker_size; ++ i) {
+    deque = _deque_list + (_worker_no + i) % _worker_size;
+    pthread_mutex_lock(&deque->mutex);
+    if(deque->head < deque->tail) {
+      region = deque->list[deque->head];
+      ++ deque->head;
+    }
+    pthread_mutex_unlock(&deque->mutex);
+  }
+  return region;
+}
+
+//////////////////////////////
+// 1つの領域に収まるペアを順番に探索
+//////////////////////////////
+static void search_route_in_region(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                                   route_t* const _route_list, int const _region) {
+  int i, region_scale, region_size;
+  object_t const* obj;
+  route_t* rt_gen;
+  route_t* rt_equ;
+  kopt_t kopt;
+
+  // 領域の中だけを書き換えるので、他のワーカーとはぶつからない
+  init_kopt(&kopt, _solver, _route_list);
+  region_scale = _solver->region_scale;
+  region_size = _solver->region_size;
+  kopt.open_snapshot = _solver->open_snapshot;
+  kopt.region_begin.x = _region / (region_scale * region_scale) * region_size;
+  kopt.region_begin.y = _region / region_scale % region_scale * region_size;
+  kopt.region_begin.z = _region % region_scale * region_size;
+  kopt.region_end.x = kopt.region_begin.x + region_size;
+  kopt.region_end.y = kopt.region_begin.y + region_size;
+  kopt.region_end.z = kopt.region_begin.z + region_size;
+  for(i = _solver->region_head[_region]; i < _solver->region_head[_region + 1]; ++ i) {
+    obj = _solver->object_list + _cost_list[_solver->region_list[i]].key;
+    rt_gen = _route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    rt_equ = _route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
+    // 単方向探索
+    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+      search_route_by_object_no(&kopt, _cost_list[_solver->region_list[i]].key);
+    }
+    // 全方向探索
+    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+      search_route_by_object_no_multi_way(&kopt, _cost_list[_solver->region_list[i]].key);
+    }
+  }
+}
+
+//////////////////////////////
+// ペアの探索範囲（全方向探索の1歩を含めて、両端を囲む箱を1部屋広げたもの、端は含む）
+//////////////////////////////
+static void search_box(object_t const* const _obj, int* const _lo, int* const _hi) {
+  _lo[0] = (_obj->gen.x < _obj->equ.x ? _obj->gen.x : _obj->equ.x) - 1;
+  _lo[1] = (_obj->gen.y < _obj->equ.y ? _obj->gen.y : _obj->equ.y) - 1;
+  _lo[2] = (_obj->gen.z < _obj->equ.z ? _obj->gen.z : _obj->equ.z) - 1;
+  _hi[0] = (_obj->gen.x > _obj->equ.x ? _obj->gen.x : _obj->equ.x) + 1;
+  _hi[1] = (_obj->gen.y > _obj->equ.y ? _obj->gen.y : _obj->equ.y) + 1;
+  _hi[2] = (_obj->gen.z > _obj->equ.z ? _obj->gen.z : _obj->equ.z) + 1;
+}
+
+//////////////////////////////
+// 衝突グラフの初期化
+// 距離が config.conflict_length 以下のペアについて、探索範囲が重なる（片方の端点がもう片方の
+// 探索範囲に入る場合を含む）ペアを隣接リスト（CSR）にする、X軸で掃引して重なる候補だけを調べる
+// 最初の構築で互いに重ならないペアを選ぶためだけに使う（修復やコストリストの並び順には使わない）
+//////////////////////////////
+static int init_conflict_graph(vigne_solver_t* const _solver) {
+  int i, j, a, b, node_size, edge_size, pass;
+  int lo_a[3], hi_a[3], lo_b[3], hi_b[3];
+  int* cursor = NULL;
+  qsort_t* node_list = NULL;
+  object_t const* obj;
+
+  free_conflict_graph(_solver);
+  // 並列構築でしか使わない
+  if(_solver->config.conflict_length <= 0 || _solver->config.threads <= 1) {
+    return 0;
+  }
+  // X座標の小さい順に並べる
+  node_list = (qsort_t*)malloc(sizeof(qsort_t) * OBJECT_SIZE);
+  cursor = (int*)malloc(sizeof(int) * (OBJECT_SIZE + 1));
+  _solver->conflict_head = (int*)calloc(OBJECT_SIZE + 1, sizeof(int));
+  _solver->independent_list = (int*)malloc(sizeof(int) * OBJECT_SIZE);
+  _solver->independent_mark = (unsigned char*)malloc(sizeof(unsigned char) * OBJECT_SIZE);
+  _solver->independent_snapshot = (unsigned char*)malloc(sizeof(unsigned char) * VIGNE_CELL_SIZE);
+  if(node_list == NULL || cursor == NULL || _solver->conflict_head == NULL
+  || _solver->independent_list == NULL || _solver->independent_mark == NULL
+  || _solver->independent_snapshot == NULL) {
+    free(node_list);
+    free(cursor);
+    free_conflict_graph(_solver);
+    return -1;
+  }
+  node_size = 0;
+  for(i = 0; i < _solver->cost_size; ++ i) {
+    obj = _solver->object_list + _solver->cost_list[i].key;
+    if(dist(obj->gen.x, obj->gen.y, obj->gen.z, obj->equ.x, obj->equ.y, obj->equ.z)
+       > _solver->config.conflict_length) {
+      continue;
+    }
+    search_box(obj, lo_a, hi_a);
+    node_list[node_size].key = _solver->cost_list[i].key;
+    node_list[node_size].value = -lo_a[0];
+    ++ node_size;
+  }
+  qsort(node_list, node_size, sizeof(qsort_t), qsort_desc);
+  // 1回目で次数を数え、2回目で隣接リストを埋める
+  for(pass = 0; pass < 2; ++ pass) {
+    for(i = 0; i < node_size; ++ i) {
+      a = node_list[i].key;
+      search_box(_solver->object_list + a, lo_a, hi_a);
+      for(j = i + 1; j < node_size && -node_list[j].value <= hi_a[0]; ++ j) {
+        b = node_list[j].key;
+        search_box(_solver->object_list + b, lo_b, hi_b);
+        if(hi_a[1] < lo_b[1] || hi_b[1] < lo_a[1] || hi_a[2] < lo_b[2] || hi_b[2] < lo_a[2]) {
+          continue;
+        }
+        if(pass == 0) {
+          ++ _solver->conflict_head[a + 1];
+          ++ _solver->conflict_head[b + 1];
+        } else {
+          _solver->conflict_list[cursor[a]] = b;
+          ++ cursor[a];
+          _solver->conflict_list[cursor[b]] = a;
+          ++ cursor[b];
+        }
+      }
+    }
+    if(pass == 0) {
+      for(i = 0; i < OBJECT_SIZE; ++ i) {
+        _solver->conflict_head[i + 1] += _solver->conflict_head[i];
+      }
+      edge_size = _solver->conflict_head[OBJECT_SIZE];
+      memcpy(cursor, _solver->conflict_head, sizeof(int) * (OBJECT_SIZE + 1));
+      if((_solver->conflict_list = (int*)malloc(sizeof(int) * (edge_size > 0 ? edge_size : 1))) == NULL) {
+        free(node_list);
+        free(cursor);
+        free_conflict_graph(_solver);
+        return -1;
+      }
+    }
+  }
+  // 独立集合の候補（グラフに含まれるペア）に印を付けておく
+  memset(_solver->independent_mark, 0, sizeof(unsigned char) * OBJECT_SIZE);
+  for(i = 0; i < node_size; ++ i) {
+    _solver->independent_mark[node_list[i].key] = 1;
+  }
+  free(node_list);
+  free(cursor);
+  return 0;
+}
+
+//////////////////////////////
+// 衝突グラフの開放
+//////////////////////////////
+static void free_conflict_graph(vigne_solver_t* const _solver) {
+  free(_solver->conflict_head);
+  free(_solver->conflict_list);
+  free(_solver->independent_list);
+  free(_solver->independent_mark);
+  free(_solver->independent_snapshot);
+  _solver->conflict_head = NULL;
+  _solver->conflict_list = NULL;
+  _solver->independent_list = NULL;
+  _solver->independent_mark = NULL;
+  _solver->independent_snapshot = NULL;
+  _solver->independent_size = 0;
+}
+
+//////////////////////////////
+// 互いに衝突しないペアを並列に探索
+// コストリストの順に、選んだペアと衝突しないペアを貪欲に選ぶ（衝突は隣接リストで次数分だけ調べる）
+// 探索範囲が重ならないので書き込みはぶつからず、範囲外の部屋の空き状況は開始時の状態を見る
+//////////////////////////////
+static void search_route_by_independent(vigne_solver_t* const _solver, route_t* const _route_list) {
+  int i, j, object_no, worker_size;
+  int started[REGION_THREAD_MAX];
+  object_t const* obj;
+  pthread_t thread_list[REGION_THREAD_MAX];
+  region_worker_t worker_list[REGION_THREAD_MAX];
+
+  // 独立集合（印は 1: 候補、2: 選んだ）
+  _solver->independent_size = 0;
+  for(i = 0; i < _solver->cost_size; ++ i) {
+    object_no = _solver->cost_list[i].key;
+    if(_solver->independent_mark[object_no] != 1) {
+      continue;
+    }
+    obj = _solver->object_list + object_no;
+    if(!IS_OPEN(_route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z))
+    || !IS_OPEN(_route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z))) {
+      continue;
+    }
+    for(j = _solver->conflict_head[object_no]; j < _solver->conflict_head[object_no + 1]; ++ j) {
+      if(_solver->independent_mark[_solver->conflict_list[j]] == 2) {
+        break;
+      }
+    }
+    if(j < _solver->conflict_head[object_no + 1]) {
+      continue;
+    }
+    _solver->independent_mark[object_no] = 2;
+    _solver->independent_list[_solver->independent_size] = object_no;
+    ++ _solver->independent_size;
+  }
+  for(i = 0; i < _solver->independent_size; ++ i) {
+    _solver->independent_mark[_solver->independent_list[i]] = 1;
+  }
+  // 開始時の部屋の空き状況
+  for(i = 0; i < VIGNE_CELL_SIZE; ++ i) {
+    _solver->independent_snapshot[i] = IS_OPEN(_route_list + i);
+  }
+  // 並列探索（自分もワーカー0として働く、ペアはワーカー数おきに受け持つ）
+  worker_size = _solver->config.threads < REGION_THREAD_MAX ? _solver->config.threads : REGION_THREAD_MAX;
+  for(i = 0; i < worker_size; ++ i) {
+    worker_list[i].solver = _solver;
+    worker_list[i].cost_list = _solver->cost_list;
+    worker_list[i].route_list = _route_list;
+    worker_list[i].worker_no = i;
+    worker_list[i].worker_size = worker_size;
+  }
+  for(i = 1; i < worker_size; ++ i) {
+    started[i] = pthread_create(thread_list + i, NULL, independent_worker, worker_list + i) == 0;
+  }
+  independent_worker(worker_list);
+  for(i = 1; i < worker_size; ++ i) {
+    if(started[i]) {
+      pthread_join(thread_list[i], NULL);
+    } else {
+      // 起動できなかったワーカーの分は自分で探索する
+      independent_worker(worker_list + i);
+    }
+  }
+}
+
+//////////////////////////////
+// 独立集合のペアを探索するワーカー
+//////////////////////////////
+static void* independent_worker(void* _arg) {
+  region_worker_t* worker = (region_worker_t*)_arg;
+  vigne_solver_t* solver = worker->solver;
+  int i, lo[3], hi[3];
+  kopt_t kopt;
+
+  init_kopt(&kopt, solver, worker->route_list);
+  kopt.open_snapshot = solver->independent_snapshot;
+  for(i = worker->worker_no; i < solver->independent_size; i += worker->worker_size) {
+    // 探索範囲の外は開始時の状態を見る
+    search_box(solver->object_list + solver->independent_list[i], lo, hi);
+    kopt.region_begin.x = lo[0];
+    kopt.region_begin.y = lo[1];
+    kopt.region_begin.z = lo[2];
+    kopt.region_end.x = hi[0] + 1;
+    kopt.region_end.y = hi[1] + 1;
+    kopt.region_end.z = hi[2] + 1;
+    search_route_pair(&kopt, solver->independent_list[i]);
+  }
+  return NULL;
+}
+
+//////////////////////////////
+// 窓ごとの先読み並列探索（確保・起動できなければ -1）
+//////////////////////////////
+static int search_route_by_speculation(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                                       route_t* const _route_list) {
+  int i, window, worker_size, started;
+  pthread_t thread_list[REGION_THREAD_MAX];
+  speculation_worker_t worker_list[REGION_THREAD_MAX];
+  speculation_t spec;
+
+  window = _solver->config.speculate_window;
+  worker_size = _solver->config.threads > REGION_THREAD_MAX ? REGION_THREAD_MAX : _solver->config.threads;
+  // メモリ確保（ワーカー1以降は順路リストの写しで先読みする）
+  spec.path_size = (int*)malloc(sizeof(int) * window);
+  spec.path_list = (int*)malloc(sizeof(int) * window * ROUTE_SIZE);
+  spec.commit_head = (int*)malloc(sizeof(int) * (window + 1));
+  spec.commit_list = (int*)malloc(sizeof(int) * window * ROUTE_SIZE);
+  for(i = 0; i < worker_size; ++ i) {
+    worker_list[i].route_list = i == 0 ? _route_list : (route_t*)malloc(sizeof(route_t) * VIGNE_CELL_SIZE);
+    if(worker_list[i].route_list == NULL) {
+      break;
+    }
+    if(i > 0) {
+      memcpy(worker_list[i].route_list, _route_list, sizeof(route_t) * VIGNE_CELL_SIZE);
+    }
+  }
+  worker_size = i;
+  if(spec.path_size == NULL || spec.path_list == NULL || spec.commit_head == NULL || spec.commit_list == NULL
+  || worker_size <= 1) {
+    for(i = 1; i < worker_size; ++ i) {
+      free(worker_list[i].route_list);
+    }
+    free(spec.path_size);
+    free(spec.path_list);
+    free(spec.commit_head);
+    free(spec.commit_list);
+    return -1;
+  }
+  // ワーカー起動（そろうまでゲートで待たせて、起動できた数で同期する）
+  spec.size = 0;
+  spec.commit_size = 0;
+  spec.commit_head[0] = 0;
+  pthread_mutex_init(&spec.gate, NULL);
+  pthread_mutex_lock(&spec.gate);
+  started = 1;
+  for(i = 0; i < worker_size; ++ i) {
+    worker_list[i].solver = _solver;
+    worker_list[i].cost_list = _cost_list;
+    worker_list[i].spec = &spec;
+    worker_list[i].worker_no = i;
+    if(i > 0) {
+      if(pthread_create(thread_list + i, NULL, speculation_worker, worker_list + i) != 0) {
+        break;
+      }
+      ++ started;
+    }
+  }
+  spec.worker_size = started;
+  pthread_barrier_init(&spec.barrier, NULL, started);
+  pthread_mutex_unlock(&spec.gate);
+  // 窓ごとに、先読み→優先順に確定
+  for(spec.begin = 0; spec.begin < _solver->cost_size; spec.begin += window) {
+    spec.size = _solver->cost_size - spec.begin < window ? _solver->cost_size - spec.begin : window;
+    pthread_barrier_wait(&spec.barrier);
+    speculation_search(worker_list);
+    pthread_barrier_wait(&spec.barrier);
+    speculation_commit(_solver, _cost_list, _route_list, &spec);
+  }
+  // ワーカー終了
+  spec.size = 0;
+  pthread_barrier_wait(&spec.barrier);
+  for(i = 1; i < started; ++ i) {
+    pthread_join(thread_list[i], NULL);
+  }
+  pthread_barrier_destroy(&spec.barrier);
+  pthread_mutex_destroy(&spec.gate);
+  for(i = 1; i < worker_size; ++ i) {
+    free(worker_list[i].route_list);
+  }
+  free(spec.path_size);
+  free(spec.path_list);
+  free(spec.commit_head);
+  free(spec.commit_list);
+  return 0;
+}
+
+//////////////////////////////
+// 先読みのワーカー
+//////////////////////////////
+static void* speculation_worker(void* _arg) {
+  speculation_worker_t* worker = (speculation_worker_t*)_arg;
+  speculation_t* spec = worker->spec;
+
+  // 全員の起動を待つ
+  pthread_mutex_lock(&spec->gate);
+  pthread_mutex_unlock(&spec->gate);
+  for(;;) {
+    pthread_barrier_wait(&spec->barrier);
+    if(spec->size == 0) {
+      break;
+    }
+    speculation_search(worker);
+    pthread_barrier_wait(&spec->barrier);
+  }
+  return NULL;
+}
+
+//////////////////////////////
+// 窓のペアのうち担当分を先読みする（順路は記録して外す）
+//////////////////////////////
+static void speculation_search(speculation_worker_t* const _worker) {
+  int i, j, size, index;
+  object_t const* obj;
+  route_t* route_list;
+  speculation_t* spec;
+  kopt_t kopt;
+
+  spec = _worker->spec;
+  route_list = _worker->route_list;
+  // 写しに前の窓で確定した順路を反映する
+  if(_worker->worker_no != 0) {
+    for(i = 0; i < spec->commit_size; ++ i) {
+      compact_link(route_list, spec->commit_list + spec->commit_head[i],
+                   spec->commit_head[i + 1] - spec->commit_head[i]);
+    }
+  }
+  init_kopt(&kopt, _worker->solver, route_list);
+  for(i = _worker->worker_no; i < spec->size; i += spec->worker_size) {
+    obj = _worker->solver->object_list + _worker->cost_list[spec->begin + i].key;
+    index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    spec->path_size[i] = 0;
+    if(!IS_OPEN(route_list + index)) {
+      continue;
+    }
+    search_route_pair(&kopt, _worker->cost_list[spec->begin + i].key);
+    if(IS_HEAD(route_list + index)) {
+      size = 0;
+      for(j = index; j != -1; j = route_list[j].next) {
+        spec->path_list[i * ROUTE_SIZE + size] = j;
+        ++ size;
+      }
+      spec->path_size[i] = size;
+      zx_remove_route(index, route_list, NULL);
+    }
+  }
+}
+
+//////////////////////////////
+// 先読みした順路を優先順に確定する（先に確定した順路が探索範囲に触れていれば探索し直す）
+//////////////////////////////
+static void speculation_commit(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                               route_t* const _route_list, speculation_t* const _spec) {
+  int i, j, size, index, object_no;
+  object_t const* obj;
+  kopt_t kopt;
+
+  init_kopt(&kopt, _solver, _route_list);
+  _spec->commit_size = 0;
+  for(i = 0; i < _spec->size; ++ i) {
+    object_no = _cost_list[_spec->begin + i].key;
+    obj = _solver->object_list + object_no;
+    index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    if(!IS_OPEN(_route_list + index) || !IS_OPEN(_route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z))) {
+      continue;
+    }
+    if(speculation_conflict(_solver, _route_list, _spec, obj)) {
+      search_route_pair(&kopt, object_no);
+    } else if(_spec->path_size[i] > 0) {
+      compact_link(_route_list, _spec->path_list + i * ROUTE_SIZE, _spec->path_size[i]);
+    }
+    // 確定した順路を記録（後のペアの判定と、写しへの反映に使う）
+    if(IS_HEAD(_route_list + index)) {
+      size = _spec->commit_head[_spec->commit_size];
+      for(j = index; j != -1; j = _route_list[j].next) {
+        _spec->commit_list[size] = j;
+        ++ size;
+      }
+      ++ _spec->commit_size;
+      _spec->commit_head[_spec->commit_size] = size;
+    }
+  }
+}
+
+//////////////////////////////
+// 窓で先に確定した順路が、ペアの探索で読む部屋に触れているか
+// （探索範囲は両端を囲む箱を1部屋広げたもの、部屋のコストはそこに置かれたペアの両端の空き状況で決まる）
+//////////////////////////////
+static int speculation_conflict(vigne_solver_t const* const _solver, route_t const* const _route_list,
+                                speculation_t const* const _spec, object_t const* const _obj) {
+  int i, k, object_no;
+  int lo[3], hi[3];
+  xyz_t const* xyz[3];
+  object_t const* obj;
+
+  search_box(_obj, lo, hi);
+  for(i = 0; i < _spec->commit_head[_spec->commit_size]; ++ i) {
+    xyz[0] = &_route_list[_spec->commit_list[i]].coord;
+    xyz[1] = NULL;
+    xyz[2] = NULL;
+    object_no = _solver->object_no_list[_spec->commit_list[i]];
+    if(object_no != -1) {
+      obj = _solver->object_list + object_no;
+      xyz[1] = &obj->gen;
+      xyz[2] = &obj->equ;
+    }
+    for(k = 0; k < 3; ++ k) {
+      if(xyz[k] != NULL && lo[0] <= xyz[k]->x && xyz[k]->x <= hi[0] && lo[1] <= xyz[k]->y && xyz[k]->y <= hi[1]
+      && lo[2] <= xyz[k]->z && xyz[k]->z <= hi[2]) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+//////////////////////////////
+// 順路の詰め直し（順路数を返す）
+//////////////////////////////
+static int compact_route(vigne_solver_t* const _solver, route_t* const _route_list) {
+  static int const delta[7][3] = {
+    {0, 0, 0}, {0, 0, 1}, {0, 0, -1}, {0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {-1, 0, 0}
+  };
+  int i, j, k, n, x, y, z, index, index_gen, object_no, retry_size;
+  int cost_old, cost_new, size_old, size_new;
+  int list_old[ROUTE_SIZE];
+  int list_new[ROUTE_SIZE];
+  qsort_t retry_list[ROUTE_SIZE * 7];
+  object_t const* obj;
+  route_t* rt_gen;
+  route_t* rt_equ;
+  kopt_t kopt;
+
+  init_kopt(&kopt, _solver, _route_list);
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    obj = _solver->object_list + i;
+    index_gen = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    rt_gen = _route_list + index_gen;
+    rt_equ = _route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
+    if(!IS_HEAD(rt_gen) || _solver->frozen[index_gen]) {
+      continue;
+    }
+    // 今の順路を外して、外した状態のコストで比べる
+    size_old = compact_unlink(_route_list, index_gen, list_old);
+    cost_old = compact_cost(&kopt, list_old, size_old);
+    compact_search(_solver, &kopt, i);
+    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+      compact_link(_route_list, list_old, size_old);
+      continue;
+    }
+    size_new = compact_unlink(_route_list, index_gen, list_new);
+    cost_new = compact_cost(&kopt, list_new, size_new);
+    // コストが下がるか、同じコストで短くなる場合だけ置き換える
+    if(cost_new > cost_old || (cost_new == cost_old && size_new >= size_old)) {
+      compact_link(_route_list, list_old, size_old);
+      continue;
+    }
+    compact_link(_route_list, list_new, size_new);
+    // 空いた部屋とその隣の部屋に置かれた、まだつながっていないペアをつなぎ直す
+    retry_size = 0;
+    for(j = 0; j < size_old; ++ j) {
+      if(!IS_OPEN(_route_list + list_old[j])) {
+        continue;
+      }
+      for(k = 0; k < 7; ++ k) {
+        x = _route_list[list_old[j]].coord.x + delta[k][0];
+        y = _route_list[list_old[j]].coord.y + delta[k][1];
+        z = _route_list[list_old[j]].coord.z + delta[k][2];
+        if(x < 0 || SCALE_SIZE <= x || y < 0 || SCALE_SIZE <= y || z < 0 || SCALE_SIZE <= z) {
+          continue;
+        }
+        index = INDEX(x, y, z);
+        object_no = _solver->object_no_list[index];
+        if(object_no == -1 || !IS_OPEN(_route_list + index)) {
+          continue;
+        }
+        for(n = 0; n < retry_size && retry_list[n].key != object_no; ++ n);
+        if(n == retry_size) {
+          retry_list[retry_size].key = object_no;
+          retry_list[retry_size].value = _solver->object_list[object_no].cost;
+          ++ retry_size;
+        }
+      }
+    }
+    // コストが高い順にソート
+    qsort(retry_list, retry_size, sizeof(qsort_t), qsort_desc);
+    for(j = 0; j < retry_size; ++ j) {
+      obj = _solver->object_list + retry_list[j].key;
+      if(IS_OPEN(_route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z))
+      && IS_OPEN(_route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z))) {
+        compact_search(_solver, &kopt, retry_list[j].key);
+      }
+    }
+  }
+  return count_route(_solver->object_list, _route_list);
+}
+
+//////////////////////////////
+// 詰め直し用の順路探索（階層探索なら DP、それ以外は K-OPT）
+//////////////////////////////
+static void compact_search(vigne_solver_t const* const _solver, kopt_t* const _kopt, int const _object_no) {
+  object_t const* obj;
+  route_t* rt_gen;
+  route_t* rt_equ;
+
+  obj = _solver->object_list + _object_no;
+  rt_gen = _kopt->route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+  rt_equ = _kopt->route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
+  // 回廊は指定しない（DP は両端を囲む箱全体を探索する）
+  if(_solver->config.tile_size > 0) {
+    search_route_by_dp(_kopt, _object_no);
+    if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+      search_route_by_dp_multi_way(_kopt, _object_no);
+    }
+    return;
+  }
+  search_route_by_object_no(_kopt, _object_no);
+  if(IS_OPEN(rt_gen) && IS_OPEN(rt_equ)) {
+    search_route_by_object_no_multi_way(_kopt, _object_no);
+  }
+}
+
+//////////////////////////////
+// 順路が通る部屋のコストの合計（発電機の部屋は除く）
+//////////////////////////////
+static int compact_cost(kopt_t const* const _kopt, int const* const _list, int const _size) {
+  int i, cost;
+
+  cost = 0;
+  for(i = 1; i < _size; ++ i) {
+    cost += kopt_cell_cost(_kopt, _list[i]);
+  }
+  return cost;
+}
+
+//////////////////////////////
+// 順路を先頭から記録して外す（部屋数を返す）
+//////////////////////////////
+static int compact_unlink(route_t* const _route_list, int const _head, int* const _list) {
+  int size, index;
+
+  size = 0;
+  for(index = _head; index != -1; index = _route_list[index].next) {
+    _list[size] = index;
+    ++ size;
+  }
+  zx_remove_route(_head, _route_list, NULL);
+  return size;
+}
+
+//////////////////////////////
+// 記録した順路を紐付け直す
+//////////////////////////////
+static void compact_link(route_t* const _route_list, int const* const _list, int const _size) {
+  int i;
+
+  for(i = 1; i < _size; ++ i) {
+    _route_list[_list[i - 1]].next = _list[i];
+    _route_list[_list[i]].prev = _list[i - 1];
+  }
+}
+
+//////////////////////////////
+// ゾーンの近くでつながらなかったペアを、押しのけ連鎖でつなぐ
+//////////////////////////////
+static void eject_route_by_zone(vigne_solver_t* const _solver, qsort_t const* const _cost_list,
+                                route_t* const _route_list, zone_t const* const _zone) {
+  int i, budget, total_before;
+  object_t const* obj;
+  kopt_t kopt;
+  eject_t eject;
+
+  init_kopt(&kopt, _solver, _route_list);
+  budget = _solver->config.eject_budget;
+  for(i = 0; i < _solver->cost_size && budget > 0; ++ i) {
+    obj = _solver->object_list + _cost_list[i].key;
+    // つながっていないペアだけ
+    if(!IS_OPEN(_route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z))
+    || !IS_OPEN(_route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z))) {
+      continue;
+    }
+    // 両端を囲む箱がゾーンと重なるペアだけ
+    if((obj->gen.x < _zone->begin.x && obj->equ.x < _zone->begin.x)
+    || (obj->gen.x > _zone->end.x && obj->equ.x > _zone->end.x)
+    || (obj->gen.y < _zone->begin.y && obj->equ.y < _zone->begin.y)
+    || (obj->gen.y > _zone->end.y && obj->equ.y > _zone->end.y)
+    || (obj->gen.z < _zone->begin.z && obj->equ.z < _zone->begin.z)
+    || (obj->gen.z > _zone->end.z && obj->equ.z > _zone->end.z)) {
+      continue;
+    }
+    -- budget;
+    // 連鎖全体で順路数が減るなら元に戻す
+    total_before = count_route(_solver->object_list, _route_list);
+    eject.size = 0;
+    eject.head[0] = 0;
+    if(eject_chain(_solver, &kopt, &eject, _cost_list[i].key, EJECT_DEPTH)
+    && count_route(_solver->object_list, _route_list) < total_before) {
+      eject_undo(_solver->object_list, _route_list, &eject, 0);
+    }
+  }
+}
+
+//////////////////////////////
+// 押しのけ連鎖（つながったら 1、つながらなければ元に戻して 0）
+//////////////////////////////
+static int eject_chain(vigne_solver_t* const _solver, kopt_t* const _kopt, eject_t* const _eject,
+                       int const _object_no, int const _depth) {
+  int i, j, n, index, object_no, size, block_size;
+  int route[ROUTE_SIZE];
+  int block_list[EJECT_ROUTE_MAX];
+  object_t const* obj;
+  route_t* route_list;
+
+  // この段で記録する操作（外す・つなぐ）が入りきらなければ諦める
+  if(_eject->size + EJECT_ROUTE_MAX * 2 + 1 > EJECT_LOG_SIZE) {
+    return 0;
+  }
+  route_list = _kopt->route_list;
+  obj = _solver->object_list + _object_no;
+  // 使用中の部屋にペナルティを付けて最小コストの経路を求める
+  if(kopt_dp_search(_kopt,
+                    obj->gen.x, obj->gen.y, obj->gen.z,
+                    obj->equ.x, obj->equ.y, obj->equ.z,
+                    -1, EJECT_PENALTY, route) == INT_MAX) {
+    return 0;
+  }
+  // 経路を塞いでいる順路（の持ち主のペア）
+  block_size = 0;
+  for(i = 0; route[i] != -1; ++ i) {
+    if(IS_OPEN(route_list + route[i])) {
+      continue;
+    }
+    // 固定した順路は押しのけない
+    if(_solver->frozen[route[i]]) {
+      return 0;
+    }
+    for(index = route[i]; route_list[index].prev != -1; index = route_list[index].prev);
+    object_no = _solver->object_no_list[index];
+    for(j = 0; j < block_size && block_list[j] != object_no; ++ j);
+    if(j < block_size) {
+      continue;
+    }
+    if(block_size == EJECT_ROUTE_MAX) {
+      return 0;
+    }
+    block_list[block_size] = object_no;
+    ++ block_size;
+  }
+  // 塞いでいる順路を記録して外す
+  size = _eject->size;
+  for(i = 0; i < block_size; ++ i) {
+    obj = _solver->object_list + block_list[i];
+    n = compact_unlink(route_list, INDEX(obj->gen.x, obj->gen.y, obj->gen.z),
+                       _eject->cell_list + _eject->head[_eject->size]);
+    _eject->object_no[_eject->size] = block_list[i];
+    _eject->head[_eject->size + 1] = _eject->head[_eject->size] + n;
+    ++ _eject->size;
+  }
+  // 目的のペアをつなぐ
+  compact_search(_solver, _kopt, _object_no);
+  obj = _solver->object_list + _object_no;
+  if(IS_OPEN(route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z))) {
+    eject_undo(_solver->object_list, route_list, _eject, size);
+    return 0;
+  }
+  _eject->object_no[_eject->size] = _object_no;
+  _eject->head[_eject->size + 1] = _eject->head[_eject->size];
+  ++ _eject->size;
+  // 外したペアをつなぎ直す（つながらなければ、さらに押しのける）
+  for(i = 0; i < block_size; ++ i) {
+    obj = _solver->object_list + block_list[i];
+    if(!IS_OPEN(route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z))
+    || !IS_OPEN(route_list + INDEX(obj->equ.x, obj->equ.y, obj->equ.z))) {
+      continue;
+    }
+    compact_search(_solver, _kopt, block_list[i]);
+    if(IS_HEAD(route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z))) {
+      _eject->object_no[_eject->size] = block_list[i];
+      _eject->head[_eject->size + 1] = _eject->head[_eject->size];
+      ++ _eject->size;
+    } else if(_depth > 1) {
+      eject_chain(_solver, _kopt, _eject, block_list[i], _depth - 1);
+    }
+  }
+  return 1;
+}
+
+//////////////////////////////
+// 押しのけ連鎖を _size 番目の操作まで逆順に戻す
+//////////////////////////////
+static void eject_undo(object_t const* const _object_list, route_t* const _route_list,
+                       eject_t* const _eject, int const _size) {
+  int i, index;
+  object_t const* obj;
+
+  for(i = _eject->size - 1; i >= _size; -- i) {
+    // 外した順路は紐付け直し、つないだ順路は外す
+    if(_eject->head[i] < _eject->head[i + 1]) {
+      compact_link(_route_list, _eject->cell_list + _eject->head[i], _eject->head[i + 1] - _eject->head[i]);
+    } else {
+      obj = _object_list + _eject->object_no[i];
+      index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+      zx_remove_route(index, _route_list, NULL);
+    }
+  }
+  _eject->size = _size;
+}
+
+//////////////////////////////
+// ゾーンを広げた範囲に収まるペアのつなぎ方を分枝限定法で探し直す（増えたペアの数を返す）
+//////////////////////////////
+static int exact_route_by_zone(vigne_solver_t* const _solver, route_t* const _route_list,
+                               zone_t const* const _zone) {
+  int i, j, k, x, y, z, index, index_equ, object_no, baseline;
+  exact_t* exact;
+  object_t const* obj;
+
+  if(_solver->config.exact_nodes <= 0) {
+    return 0;
+  }
+  exact = _solver->exact;
+  exact->box.begin.x = _zone->begin.x - EXACT_MARGIN < 0 ? 0 : _zone->begin.x - EXACT_MARGIN;
+  exact->box.begin.y = _zone->begin.y - EXACT_MARGIN < 0 ? 0 : _zone->begin.y - EXACT_MARGIN;
+  exact->box.begin.z = _zone->begin.z - EXACT_MARGIN < 0 ? 0 : _zone->begin.z - EXACT_MARGIN;
+  exact->box.end.x = _zone->end.x + EXACT_MARGIN >= SCALE_SIZE ? SCALE_SIZE - 1 : _zone->end.x + EXACT_MARGIN;
+  exact->box.end.y = _zone->end.y + EXACT_MARGIN >= SCALE_SIZE ? SCALE_SIZE - 1 : _zone->end.y + EXACT_MARGIN;
+  exact->box.end.z = _zone->end.z + EXACT_MARGIN >= SCALE_SIZE ? SCALE_SIZE - 1 : _zone->end.z + EXACT_MARGIN;
+  // 両端が範囲内にあり、順路が無いか順路が範囲内に収まるペアを集める
+  exact->pair_size = 0;
+  baseline = 0;
+  for(x = exact->box.begin.x; x <= exact->box.end.x; ++ x) {
+    for(y = exact->box.begin.y; y <= exact->box.end.y; ++ y) {
+      for(z = exact->box.begin.z; z <= exact->box.end.z; ++ z) {
+        index = INDEX(x, y, z);
+        object_no = _solver->object_no_list[index];
+        if(object_no == -1 || _solver->frozen[index]) {
+          continue;
+        }
+        obj = _solver->object_list + object_no;
+        if(obj->gen.x != x || obj->gen.y != y || obj->gen.z != z
+        || exact_local(exact, obj->equ.x, obj->equ.y, obj->equ.z) == -1) {
+          continue;
+        }
+        if(IS_HEAD(_route_list + index)) {
+          if(!zx_inner_zone(exact->box.begin.x, exact->box.end.x,
+                            exact->box.begin.y, exact->box.end.y,
+                            exact->box.begin.z, exact->box.end.z,
+                            index, _route_list)) {
+            continue;
+          }
+          ++ baseline;
+        }
+        // 多すぎる場合は貪欲法の結果のままにする
+        if(exact->pair_size == EXACT_PAIR_MAX) {
+          return 0;
+        }
+        exact->object_no[exact->pair_size] = object_no;
+        ++ exact->pair_size;
+      }
+    }
+  }
+  // 全部つながっていれば探し直すまでもない
+  if(baseline == exact->pair_size) {
+    return 0;
+  }
+  // 対象の順路を外す
+  for(i = 0; i < exact->pair_size; ++ i) {
+    obj = _solver->object_list + exact->object_no[i];
+    index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    exact->saved_size[i] = IS_HEAD(_route_list + index) ? compact_unlink(_route_list, index, exact->saved_list[i]) : 0;
+  }
+  // 候補経路（範囲内の空き部屋を通る最短経路）を列挙する（行き止まりも数えて、ペアごとにノード数の上限で打ち切る）
+  exact->node_limit = _solver->config.exact_nodes;
+  for(i = 0; i < exact->pair_size; ++ i) {
+    obj = _solver->object_list + exact->object_no[i];
+    exact->path_size[i] = 0;
+    exact->node = 0;
+    index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    index_equ = INDEX(obj->equ.x, obj->equ.y, obj->equ.z);
+    if(IS_OPEN(_route_list + index) && IS_OPEN(_route_list + index_equ)) {
+      exact->depth_path[0] = index;
+      exact_path(_solver, exact, _route_list, i, obj->gen.x, obj->gen.y, obj->gen.z,
+                 obj->equ.x, obj->equ.y, obj->equ.z, 1);
+    }
+  }
+  // 候補が少ないペアから分枝する
+  for(i = 0; i < exact->pair_size; ++ i) {
+    for(j = i; j > 0 && exact->path_size[exact->order[j - 1]] > exact->path_size[i]; -- j) {
+      exact->order[j] = exact->order[j - 1];
+    }
+    exact->order[j] = i;
+  }
+  for(i = 0; i < exact->pair_size; ++ i) {
+    exact->choice[i] = -1;
+  }
+  memset(exact->used, 0, sizeof(exact->used));
+  exact->best = baseline;
+  exact->node = 0;
+  exact_branch(exact, 0, 0);
+  // 改善しなければ元の順路に戻す
+  if(exact->best <= baseline) {
+    for(i = 0; i < exact->pair_size; ++ i) {
+      if(exact->saved_size[i] > 0) {
+        compact_link(_route_list, exact->saved_list[i], exact->saved_size[i]);
+      }
+    }
+    return 0;
+  }
+  for(i = 0; i < exact->pair_size; ++ i) {
+    k = exact->best_choice[i];
+    if(k != -1) {
+      compact_link(_route_list, exact->path_list[i][k], exact->path_length[i][k]);
+    }
+  }
+  return exact->best - baseline;
+}
+
+//////////////////////////////
+// 範囲内の位置（範囲外なら -1）
+//////////////////////////////
+static int exact_local(exact_t const* const _exact, int const _x, int const _y, int const _z) {
+  zone_t const* box;
+
+  box = &_exact->box;
+  if(_x < box->begin.x || box->end.x < _x || _y < box->begin.y || box->end.y < _y
+  || _z < box->begin.z || box->end.z < _z) {
+    return -1;
+  }
+  return ((_x - box->begin.x) * EXACT_SCALE + (_y - box->begin.y)) * EXACT_SCALE + (_z - box->begin.z);
+}
+
+//////////////////////////////
+// 候補経路の列挙（空き部屋だけを通る最短経路、軸の順番はランダム）
+//////////////////////////////
+static void exact_path(vigne_solver_t* const _solver, exact_t* const _exact, route_t const* const _route_list,
+                       int const _pair, int const _x, int const _y, int const _z,
+                       int const _to_x, int const _to_y, int const _to_z, int const _depth) {
+  int i, k, r, x, y, z, no, local;
+  int axis[3];
+
+  if(_exact->path_size[_pair] == EXACT_PATH_MAX || _exact->node >= _exact->node_limit) {
+    return;
+  }
+  ++ _exact->node;
+  // 目的地点に到達したら記録
+  if(_x == _to_x && _y == _to_y && _z == _to_z) {
+    no = _exact->path_size[_pair];
+    memcpy(_exact->path_list[_pair][no], _exact->depth_path, sizeof(int) * _depth);
+    memset(_exact->path_bit[_pair][no], 0, sizeof(uint64_t) * EXACT_WORD);
+    for(i = 0; i < _depth; ++ i) {
+      local = exact_local(_exact, _route_list[_exact->depth_path[i]].coord.x,
+                          _route_list[_exact->depth_path[i]].coord.y, _route_list[_exact->depth_path[i]].coord.z);
+      _exact->path_bit[_pair][no][local / 64] |= (uint64_t)1 << (local % 64);
+    }
+    _exact->path_length[_pair][no] = _depth;
+    ++ _exact->path_size[_pair];
+    return;
+  }
+  axis[0] = 0;
+  axis[1] = 1;
+  axis[2] = 2;
+  for(i = 2; i > 0; -- i) {
+    r = (int)(urand(&_solver->rand) * (double)(i + 1));
+    k = axis[i];
+    axis[i] = axis[r];
+    axis[r] = k;
+  }
+  for(i = 0; i < 3; ++ i) {
+    x = _x;
+    y = _y;
+    z = _z;
+    if(axis[i] == 0 && _x != _to_x) {
+      x += _x < _to_x ? 1 : -1;
+    } else if(axis[i] == 1 && _y != _to_y) {
+      y += _y < _to_y ? 1 : -1;
+    } else if(axis[i] == 2 && _z != _to_z) {
+      z += _z < _to_z ? 1 : -1;
+    } else {
+      continue;
+    }
+    // 範囲内の空き部屋だけを通る
+    if(exact_local(_exact, x, y, z) == -1 || !IS_OPEN(_route_list + INDEX(x, y, z))) {
+      continue;
+    }
+    _exact->depth_path[_depth] = INDEX(x, y, z);
+    exact_path(_solver, _exact, _route_list, _pair, x, y, z, _to_x, _to_y, _to_z, _depth + 1);
+  }
+}
+
+//////////////////////////////
+// 分枝限定法（_k 番目のペアの候補経路を選ぶ、つながないことも選べる）
+//////////////////////////////
+static void exact_branch(exact_t* const _exact, int const _k, int const _routed) {
+  int i, w, pair;
+  uint64_t const* bit;
+
+  ++ _exact->node;
+  if(_exact->node > _exact->node_limit) {
+    return;
+  }
+  if(_routed > _exact->best) {
+    _exact->best = _routed;
+    memcpy(_exact->best_choice, _exact->choice, sizeof(int) * _exact->pair_size);
+  }
+  // 残りを全部つないでも最良に届かなければ打ち切る
+  if(_k == _exact->pair_size || _routed + (_exact->pair_size - _k) <= _exact->best) {
+    return;
+  }
+  pair = _exact->order[_k];
+  for(i = 0; i < _exact->path_size[pair]; ++ i) {
+    bit = _exact->path_bit[pair][i];
+    for(w = 0; w < EXACT_WORD && (_exact->used[w] & bit[w]) == 0; ++ w);
+    if(w < EXACT_WORD) {
+      continue;
+    }
+    for(w = 0; w < EXACT_WORD; ++ w) {
+      _exact->used[w] |= bit[w];
+    }
+    _exact->choice[pair] = i;
+    exact_branch(_exact, _k + 1, _routed + 1);
+    _exact->choice[pair] = -1;
+    for(w = 0; w < EXACT_WORD; ++ w) {
+      _exact->used[w] &= ~bit[w];
+    }
+  }
+  exact_branch(_exact, _k + 1, _routed);
+}
+
+//////////////////////////////
+// 上界の初期化
+//////////////////////////////
+static int init_bound(vigne_solver_t* const _solver) {
+  int i, k, x, y, z, total, tile_scale;
+  int tile[2], demand[2];
+  xyz_t const* xyz[2];
+  qsort_t* length_list;
+  bound_t* bound;
+
+  bound = &_solver->bound;
+  free_bound(bound);
+  tile_scale = (SCALE_SIZE + BOUND_TILE_SIZE - 1) / BOUND_TILE_SIZE;
+  bound->tile_scale = tile_scale;
+  bound->tile_count = tile_scale * tile_scale * tile_scale;
+  // メモリ確保
+  bound->lambda = (double*)malloc(sizeof(double) * bound->tile_count);
+  bound->grad = (double*)malloc(sizeof(double) * bound->tile_count);
+  bound->capacity = (int*)malloc(sizeof(int) * bound->tile_count);
+  bound->length = (int*)malloc(sizeof(int) * OBJECT_SIZE);
+  bound->tile = (int*)malloc(sizeof(int) * OBJECT_SIZE * 2);
+  bound->demand = (int*)malloc(sizeof(int) * OBJECT_SIZE * 2);
+  length_list = (qsort_t*)malloc(sizeof(qsort_t) * OBJECT_SIZE);
+  if(bound->lambda == NULL || bound->grad == NULL || bound->capacity == NULL
+  || bound->length == NULL || bound->tile == NULL || bound->demand == NULL || length_list == NULL) {
+    free(length_list);
+    free_bound(bound);
+    return -1;
+  }
+  // タイルの容量（部屋数）
+  memset(bound->capacity, 0, sizeof(int) * bound->tile_count);
+  for(x = 0; x < SCALE_SIZE; ++ x) {
+    for(y = 0; y < SCALE_SIZE; ++ y) {
+      for(z = 0; z < SCALE_SIZE; ++ z) {
+        ++ bound->capacity[TILE_INDEX(tile_scale, x / BOUND_TILE_SIZE, y / BOUND_TILE_SIZE, z / BOUND_TILE_SIZE)];
+      }
+    }
+  }
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    xyz[0] = &_solver->object_list[i].gen;
+    xyz[1] = &_solver->object_list[i].equ;
+    bound->length[i] = dist(xyz[0]->x, xyz[0]->y, xyz[0]->z, xyz[1]->x, xyz[1]->y, xyz[1]->z) + 1;
+    length_list[i].key = i;
+    length_list[i].value = -bound->length[i];
+    // 端点のタイルから出るまでに、そのタイルの部屋を最低限使う数
+    for(k = 0; k < 2; ++ k) {
+      tile[k] = TILE_INDEX(tile_scale, xyz[k]->x / BOUND_TILE_SIZE, xyz[k]->y / BOUND_TILE_SIZE,
+                           xyz[k]->z / BOUND_TILE_SIZE);
+      demand[k] = bound_exit(xyz[k]->x, xyz[k]->y, xyz[k]->z, BOUND_TILE_SIZE);
+    }
+    // 両端が同じタイルなら、タイルの中でつなぐか、両端からそれぞれタイルを出るか
+    if(tile[0] == tile[1]) {
+      demand[0] = demand[0] + demand[1] < bound->length[i] ? demand[0] + demand[1] : bound->length[i];
+      tile[1] = -1;
+      demand[1] = 0;
+    }
+    for(k = 0; k < 2; ++ k) {
+      bound->tile[i * 2 + k] = tile[k];
+      bound->demand[i * 2 + k] = demand[k];
+    }
+  }
+  // 順路は距離 + 1 部屋を使い、1つの部屋は1つの順路しか通れない
+  // → 短いペアから詰めていき、全部屋数に収まる数が上界
+  qsort(length_list, OBJECT_SIZE, sizeof(qsort_t), qsort_desc);
+  total = 0;
+  for(i = 0; i < OBJECT_SIZE && total + bound->length[length_list[i].key] <= CELL_COUNT; ++ i) {
+    total += bound->length[length_list[i].key];
+  }
+  bound->value = i;
+  // ラグランジュ緩和の初期値（部屋数の制約は、収まらなかった最初のペアの長さで割った値から始める）
+  bound->mu = i < OBJECT_SIZE ? 1.0 / (double)bound->length[length_list[i].key] : 0.0;
+  for(i = 0; i < bound->tile_count; ++ i) {
+    bound->lambda[i] = 0.0;
+  }
+  bound->best = (double)OBJECT_SIZE;
+  bound->theta = 2.0;
+  bound->stale = 0;
+  free(length_list);
+  return 0;
+}
+
+//////////////////////////////
+// 上界の開放
+//////////////////////////////
+static void free_bound(bound_t* const _bound) {
+  free(_bound->lambda);
+  free(_bound->grad);
+  free(_bound->capacity);
+  free(_bound->length);
+  free(_bound->tile);
+  free(_bound->demand);
+  _bound->lambda = NULL;
+  _bound->grad = NULL;
+  _bound->capacity = NULL;
+  _bound->length = NULL;
+  _bound->tile = NULL;
+  _bound->demand = NULL;
+}
+
+//////////////////////////////
+// 部屋からタイルの外に出るまでに通るタイル内の部屋数（グリッドの端の面からは出られない）
+//////////////////////////////
+static int bound_exit(int const _x, int const _y, int const _z, int const _tile_size) {
+  int k, lo, hi, exit;
+  int xyz[3];
+
+  xyz[0] = _x;
+  xyz[1] = _y;
+  xyz[2] = _z;
+  exit = SCALE_SIZE * 3;
+  for(k = 0; k < 3; ++ k) {
+    lo = xyz[k] / _tile_size * _tile_size;
+    hi = lo + _tile_size;
+    if(lo > 0 && xyz[k] - lo + 1 < exit) {
+      exit = xyz[k] - lo + 1;
+    }
+    if(hi < SCALE_SIZE && hi - xyz[k] < exit) {
+      exit = hi - xyz[k];
+    }
+  }
+  return exit;
+}
+
+//////////////////////////////
+// 上界の絞り込み（ラグランジュ緩和の劣勾配法）
+// 全部屋数とタイルごとの部屋数の制約を乗数で目的関数に入れると、どの乗数でも順路数の上界になる
+//////////////////////////////
+static void bound_iterate(vigne_solver_t* const _solver, int const _iteration) {
+  int i, k, n, tile;
+  double value, reduced, grad_mu, norm, step;
+  bound_t* bound;
+
+  bound = &_solver->bound;
+  for(n = 0; n < _iteration && bound->theta >= BOUND_THETA_MIN; ++ n) {
+    // 乗数を固定すると、ペアごとに独立に選べる
+    value = bound->mu * (double)CELL_COUNT;
+    grad_mu = (double)CELL_COUNT;
+    for(i = 0; i < bound->tile_count; ++ i) {
+      value += bound->lambda[i] * (double)bound->capacity[i];
+      bound->grad[i] = (double)bound->capacity[i];
+    }
+    for(i = 0; i < OBJECT_SIZE; ++ i) {
+      reduced = 1.0 - bound->mu * (double)bound->length[i];
+      for(k = 0; k < 2; ++ k) {
+        tile = bound->tile[i * 2 + k];
+        if(tile != -1) {
+          reduced -= bound->lambda[tile] * (double)bound->demand[i * 2 + k];
+        }
+      }
+      if(reduced <= 0.0) {
+        continue;
+      }
+      value += reduced;
+      grad_mu -= (double)bound->length[i];
+      for(k = 0; k < 2; ++ k) {
+        tile = bound->tile[i * 2 + k];
+        if(tile != -1) {
+          bound->grad[tile] -= (double)bound->demand[i * 2 + k];
+        }
+      }
+    }
+    // 上界の更新
+    if(value < bound->best - 1e-9) {
+      bound->best = value;
+      bound->stale = 0;
+      if((int)(value + 1e-9) < bound->value) {
+        bound->value = (int)(value + 1e-9);
+      }
+    } else if(++ bound->stale >= BOUND_STALE) {
+      bound->theta *= 0.5;
+      bound->stale = 0;
+    }
+    // 現在の順路数を目標値にしてステップ幅を決める
+    norm = grad_mu * grad_mu;
+    for(i = 0; i < bound->tile_count; ++ i) {
+      norm += bound->grad[i] * bound->grad[i];
+    }
+    if(norm <= 0.0 || value <= (double)_solver->total) {
+      break;
+    }
+    step = bound->theta * (value - (double)_solver->total) / norm;
+    bound->mu -= step * grad_mu;
+    if(bound->mu < 0.0) {
+      bound->mu = 0.0;
+    }
+    for(i = 0; i < bound->tile_count; ++ i) {
+      bound->lambda[i] -= step * bound->grad[i];
+      if(bound->lambda[i] < 0.0) {
+        bound->lambda[i] = 0.0;
+      }
+    }
+  }
+}
+
+//////////////////////////////
+// エリート解の初期化
+//////////////////////////////
+static int init_elite_list(vigne_solver_t* const _solver) {
+  int i, elite_size;
+
+  free_elite_list(_solver);
+  elite_size = _solver->config.elite_size;
+  if(elite_size <= 0) {
+    return 0;
+  }
+  // メモリ確保（エリート解の中身は登録するときに必要なだけ確保する）
+  _solver->elite_list = (elite_t*)malloc(sizeof(elite_t) * elite_size);
+  _solver->elite_work.object_no = (int*)malloc(sizeof(int) * OBJECT_SIZE);
+  _solver->elite_work.code_head = (int*)malloc(sizeof(int) * (OBJECT_SIZE + 1));
+  _solver->elite_work.code = (uint8_t*)malloc(sizeof(uint8_t) * (CELL_COUNT * 3 / 8 + 2));
+  _solver->route_relink = (route_t*)malloc(sizeof(route_t) * VIGNE_CELL_SIZE);
+  if(_solver->elite_list == NULL || _solver->elite_work.object_no == NULL
+  || _solver->elite_work.code_head == NULL || _solver->elite_work.code == NULL
+  || _solver->route_relink == NULL) {
+    free_elite_list(_solver);
+    return -1;
+  }
+  _solver->elite_capacity = elite_size;
+  for(i = 0; i < elite_size; ++ i) {
+    _solver->elite_list[i].total = -1;
+    _solver->elite_list[i].object_no = NULL;
+    _solver->elite_list[i].code_head = NULL;
+    _solver->elite_list[i].code = NULL;
+  }
+  _solver->elite_size = 0;
+  return 0;
+}
+
+//////////////////////////////
+// エリート解の開放
+//////////////////////////////
+static void free_elite_list(vigne_solver_t* const _solver) {
+  int i;
+
+  if(_solver->elite_list != NULL) {
+    for(i = 0; i < _solver->elite_capacity; ++ i) {
+      free(_solver->elite_list[i].object_no);
+      free(_solver->elite_list[i].code_head);
+      free(_solver->elite_list[i].code);
+    }
+  }
+  free(_solver->elite_list);
+  free(_solver->elite_work.object_no);
+  free(_solver->elite_work.code_head);
+  free(_solver->elite_work.code);
+  free(_solver->route_relink);
+  _solver->elite_list = NULL;
+  _solver->elite_work.object_no = NULL;
+  _solver->elite_work.code_head = NULL;
+  _solver->elite_work.code = NULL;
+  _solver->route_relink = NULL;
+  _solver->elite_size = 0;
+  _solver->elite_capacity = 0;
+}
+
+//////////////////////////////
+// 順路を方向コードに圧縮（Z+, Z-, Y+, Y-, X+, X- を 0〜5 の3ビットで表す）
+//////////////////////////////
+static void elite_encode(vigne_solver_t const* const _solver, route_t const* const _route_list,
+                         elite_t* const _elite) {
+  int i, index, next, bit, code;
+  object_t const* obj;
+  route_t const* rt;
+
+  _elite->total = 0;
+  _elite->code_head[0] = 0;
+  bit = 0;
+  memset(_elite->code, 0, sizeof(uint8_t) * (CELL_COUNT * 3 / 8 + 2));
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    obj = _solver->object_list + i;
+    index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    if(!IS_HEAD(_route_list + index)) {
+      continue;
+    }
+    // 発電機から1歩ずつ方向を記録
+    for(next = _route_list[index].next; next != -1; index = next, next = _route_list[next].next) {
+      rt = _route_list + next;
+      if(rt->coord.z != _route_list[index].coord.z) {
+        code = rt->coord.z > _route_list[index].coord.z ? 0 : 1;
+      } else if(rt->coord.y != _route_list[index].coord.y) {
+        code = rt->coord.y > _route_list[index].coord.y ? 2 : 3;
+      } else {
+        code = rt->coord.x > _route_list[index].coord.x ? 4 : 5;
+      }
+      _elite->code[bit >> 3] |= (uint8_t)(code << (bit & 7));
+      if((bit & 7) > 5) {
+        _elite->code[(bit >> 3) + 1] |= (uint8_t)(code >> (8 - (bit & 7)));
+      }
+      bit += 3;
+    }
+    _elite->object_no[_elite->total] = i;
+    ++ _elite->total;
+    _elite->code_head[_elite->total] = bit;
+  }
+}
+
+//////////////////////////////
+// 圧縮した順路を部屋のINDEXの列に戻す（部屋数を返す）
+//////////////////////////////
+static int elite_decode(vigne_solver_t const* const _solver, elite_t const* const _elite, int const _no,
+                        int* const _list) {
+  static int const delta[6][3] = {
+    {0, 0, 1}, {0, 0, -1}, {0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {-1, 0, 0}
+  };
+  int x, y, z, bit, code, size;
+  object_t const* obj;
+
+  obj = _solver->object_list + _elite->object_no[_no];
+  x = obj->gen.x;
+  y = obj->gen.y;
+  z = obj->gen.z;
+  _list[0] = INDEX(x, y, z);
+  size = 1;
+  for(bit = _elite->code_head[_no]; bit < _elite->code_head[_no + 1]; bit += 3) {
+    code = _elite->code[bit >> 3] >> (bit & 7);
+    if((bit & 7) > 5) {
+      code |= _elite->code[(bit >> 3) + 1] << (8 - (bit & 7));
+    }
+    code &= 7;
+    x += delta[code][0];
+    y += delta[code][1];
+    z += delta[code][2];
+    _list[size] = INDEX(x, y, z);
+    ++ size;
+  }
+  return size;
+}
+
+//////////////////////////////
+// 2つの解の距離（片方にしか無い順路と、形の違う順路の数）
+//////////////////////////////
+static int elite_distance(elite_t const* const _a, elite_t const* const _b) {
+  int i, j, k, distance, size;
+
+  distance = 0;
+  i = 0;
+  j = 0;
+  while(i < _a->total || j < _b->total) {
+    if(j >= _b->total || (i < _a->total && _a->object_no[i] < _b->object_no[j])) {
+      ++ distance;
+      ++ i;
+      continue;
+    }
+    if(i >= _a->total || _b->object_no[j] < _a->object_no[i]) {
+      ++ distance;
+      ++ j;
+      continue;
+    }
+    // 同じペアなら方向コードを比べる
+    size = _a->code_head[i + 1] - _a->code_head[i];
+    if(size != _b->code_head[j + 1] - _b->code_head[j]) {
+      ++ distance;
+    } else {
+      for(k = 0; k < size; ++ k) {
+        if(((_a->code[(_a->code_head[i] + k) >> 3] >> ((_a->code_head[i] + k) & 7)) & 1)
+        != ((_b->code[(_b->code_head[j] + k) >> 3] >> ((_b->code_head[j] + k) & 7)) & 1)) {
+          ++ distance;
+          break;
+        }
+      }
+    }
+    ++ i;
+    ++ j;
+  }
+  return distance;
+}
+
+//////////////////////////////
+// エリート解の候補を登録（近い解があればどちらか良い方だけを残す）
+//////////////////////////////
+static void elite_offer(vigne_solver_t* const _solver, route_t const* const _route_list, int const _total) {
+  int i, worst, near, bits;
+  elite_t* elite;
+  elite_t* work;
+
+  if(_solver->elite_list == NULL) {
+    return;
+  }
+  // 最も悪い解
+  worst = -1;
+  for(i = 0; i < _solver->elite_size; ++ i) {
+    if(worst == -1 || _solver->elite_list[i].total < _solver->elite_list[worst].total) {
+      worst = i;
+    }
+  }
+  if(_solver->elite_size == _solver->elite_capacity && _total <= _solver->elite_list[worst].total) {
+    return;
+  }
+  // 圧縮して、距離が近い解を探す
+  work = &_solver->elite_work;
+  elite_encode(_solver, _route_list, work);
+  near = -1;
+  for(i = 0; i < _solver->elite_size; ++ i) {
+    if(elite_distance(work, _solver->elite_list + i) * ELITE_DISTANCE_RATE < _total) {
+      near = i;
+      break;
+    }
+  }
+  if(near != -1) {
+    if(_total <= _solver->elite_list[near].total) {
+      return;
+    }
+    elite = _solver->elite_list + near;
+  } else if(_solver->elite_size < _solver->elite_capacity) {
+    elite = _solver->elite_list + _solver->elite_size;
+    ++ _solver->elite_size;
+  } else {
+    elite = _solver->elite_list + worst;
+  }
+  // 必要な大きさだけ確保して複写
+  bits = work->code_head[work->total];
+  free(elite->object_no);
+  free(elite->code_head);
+  free(elite->code);
+  elite->object_no = (int*)malloc(sizeof(int) * (work->total + 1));
+  elite->code_head = (int*)malloc(sizeof(int) * (work->total + 1));
+  elite->code = (uint8_t*)malloc(sizeof(uint8_t) * (bits / 8 + 2));
+  if(elite->object_no == NULL || elite->code_head == NULL || elite->code == NULL) {
+    free(elite->object_no);
+    free(elite->code_head);
+    free(elite->code);
+    elite->object_no = NULL;
+    elite->code_head = NULL;
+    elite->code = NULL;
+    elite->total = 0;
+    return;
+  }
+  elite->total = work->total;
+  memcpy(elite->object_no, work->object_no, sizeof(int) * work->total);
+  memcpy(elite->code_head, work->code_head, sizeof(int) * (work->total + 1));
+  memcpy(elite->code, work->code, sizeof(uint8_t) * (bits / 8 + 2));
+}
+
+//////////////////////////////
+// パスリリンキング（親順路から、エリート解の順路を領域ごとに取り込みながら近づける）
+//////////////////////////////
+static int path_relink(vigne_solver_t* const _solver, elite_t const* const _elite) {
+  int i, j, k, n, r, x, y, z, size, total, region_size, improved;
+  int order[RELINK_SPLIT * RELINK_SPLIT * RELINK_SPLIT];
+  int list[ROUTE_SIZE];
+  route_t* route_list;
+  zone_t zone;
+
+  route_list = _solver->route_relink;
+  memcpy(route_list, _solver->route_parent, sizeof(route_t) * VIGNE_CELL_SIZE);
+  // 領域の順番はランダム
+  size = RELINK_SPLIT * RELINK_SPLIT * RELINK_SPLIT;
+  for(i = 0; i < size; ++ i) {
+    order[i] = i;
+  }
+  for(i = size - 1; i > 0; -- i) {
+    r = (int)(urand(&_solver->rand) * (double)(i + 1));
+    k = order[i];
+    order[i] = order[r];
+    order[r] = k;
+  }
+  region_size = (SCALE_SIZE + RELINK_SPLIT - 1) / RELINK_SPLIT;
+  improved = 0;
+  for(i = 0; i < size; ++ i) {
+    zone.begin.x = order[i] / (RELINK_SPLIT * RELINK_SPLIT) * region_size;
+    zone.begin.y = order[i] / RELINK_SPLIT % RELINK_SPLIT * region_size;
+    zone.begin.z = order[i] % RELINK_SPLIT * region_size;
+    zone.end.x = zone.begin.x + region_size - 1 < SCALE_SIZE ? zone.begin.x + region_size - 1 : SCALE_SIZE - 1;
+    zone.end.y = zone.begin.y + region_size - 1 < SCALE_SIZE ? zone.begin.y + region_size - 1 : SCALE_SIZE - 1;
+    zone.end.z = zone.begin.z + region_size - 1 < SCALE_SIZE ? zone.begin.z + region_size - 1 : SCALE_SIZE - 1;
+    // 領域に接している順路を削除
+    for(x = zone.begin.x; x <= zone.end.x; ++ x) {
+      for(y = zone.begin.y; y <= zone.end.y; ++ y) {
+        for(z = zone.begin.z; z <= zone.end.z; ++ z) {
+          zx_remove_route(INDEX(x, y, z), route_list, _solver->frozen);
+        }
+      }
+    }
+    // 領域に接しているエリート解の順路を取り込む（ぶつかる順路は外す）
+    for(j = 0; j < _elite->total; ++ j) {
+      n = elite_decode(_solver, _elite, j, list);
+      // 固定した順路の部屋を通るものは取り込まない
+      for(k = 0; k < n && !_solver->frozen[list[k]]; ++ k);
+      if(k < n) {
+        continue;
+      }
+      for(k = 0; k < n; ++ k) {
+        x = route_list[list[k]].coord.x;
+        y = route_list[list[k]].coord.y;
+        z = route_list[list[k]].coord.z;
+        if(zone.begin.x <= x && x <= zone.end.x && zone.begin.y <= y && y <= zone.end.y
+        && zone.begin.z <= z && z <= zone.end.z) {
+          break;
+        }
+      }
+      if(k == n) {
+        continue;
+      }
+      for(k = 0; k < n; ++ k) {
+        zx_remove_route(list[k], route_list, _solver->frozen);
+      }
+      compact_link(route_list, list, n);
+    }
+    // 順路再構築
+    shuffle_cost_list(_solver->cost_list, _solver->cost_size, &_solver->rand);
+    qsort(_solver->cost_list, _solver->cost_size, sizeof(qsort_t), qsort_desc);
+    search_route(_solver, _solver->cost_list, route_list, 0);
+    eject_route_by_zone(_solver, _solver->cost_list, route_list, &zone);
+    // 途中の解が親順路より良ければ更新
+    total = count_route(_solver->object_list, route_list);
+    if(total > _solver->total) {
+      _solver->total = total;
+      memcpy(_solver->route_parent, route_list, sizeof(route_t) * VIGNE_CELL_SIZE);
+      if(_solver->config.on_update != NULL) {
+        _solver->config.on_update(_solver->config.user, _solver, _solver->total, _solver->stale);
+      }
+      _solver->stale = 0;
+      improved = 1;
+    }
+  }
+  // 取り込み中のエリート解を置き換えないように、登録は最後に行う
+  if(improved) {
+    elite_offer(_solver, _solver->route_parent, _solver->total);
+  }
+  return improved;
+}
+
+//////////////////////////////
+// 前処理（他のペアとぶつからずにつなぐしかないペアを固定する）
+//////////////////////////////
+static int presolve(vigne_solver_t* const _solver, route_t* const _route_list) {
+  int i, j, k, n, x, y, z, size, index, scale;
+  int lo[3], hi[3], step[3];
+  int list[ROUTE_SIZE];
+  int* cover;
+  object_t const* obj;
+  qsort_t const* cost;
+
+  // 各部屋を探索範囲（両端を囲む箱を1部屋広げたもの）に含むペアの数（3次元の累積和で数える）
+  scale = SCALE_SIZE + 1;
+  if((cover = (int*)calloc(scale * scale * scale, sizeof(int))) == NULL) {
+    return -1;
+  }
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    obj = _solver->object_list + i;
+    search_box(obj, lo, hi);
+    // 累積和の終端は箱の1つ先
+    for(k = 0; k < 3; ++ k) {
+      lo[k] = lo[k] < 0 ? 0 : lo[k];
+      hi[k] = hi[k] + 1 > SCALE_SIZE ? SCALE_SIZE : hi[k] + 1;
+    }
+    for(k = 0; k < 8; ++ k) {
+      x = k & 4 ? hi[0] : lo[0];
+      y = k & 2 ? hi[1] : lo[1];
+      z = k & 1 ? hi[2] : lo[2];
+      cover[(x * scale + y) * scale + z] += (((k & 4) != 0) + ((k & 2) != 0) + ((k & 1) != 0)) % 2 ? -1 : 1;
+    }
+  }
+  for(x = 0; x < scale; ++ x) {
+    for(y = 0; y < scale; ++ y) {
+      for(z = 1; z < scale; ++ z) {
+        cover[(x * scale + y) * scale + z] += cover[(x * scale + y) * scale + z - 1];
+      }
+    }
+  }
+  for(x = 0; x < scale; ++ x) {
+    for(y = 1; y < scale; ++ y) {
+      for(z = 0; z < scale; ++ z) {
+        cover[(x * scale + y) * scale + z] += cover[(x * scale + y - 1) * scale + z];
+      }
+    }
+  }
+  for(x = 1; x < scale; ++ x) {
+    for(y = 0; y < scale; ++ y) {
+      for(z = 0; z < scale; ++ z) {
+        cover[(x * scale + y) * scale + z] += cover[((x - 1) * scale + y) * scale + z];
+      }
+    }
+  }
+  // 両端が隣り合うペア（自分の2部屋しか使わない）と、
+  // 両端が一直線上にあって、間の部屋が空き部屋で他のどのペアの探索範囲にも入らないペアを固定する
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    obj = _solver->object_list + i;
+    step[0] = obj->equ.x > obj->gen.x ? 1 : (obj->equ.x < obj->gen.x ? -1 : 0);
+    step[1] = obj->equ.y > obj->gen.y ? 1 : (obj->equ.y < obj->gen.y ? -1 : 0);
+    step[2] = obj->equ.z > obj->gen.z ? 1 : (obj->equ.z < obj->gen.z ? -1 : 0);
+    if((step[0] != 0) + (step[1] != 0) + (step[2] != 0) != 1) {
+      continue;
+    }
+    x = obj->gen.x;
+    y = obj->gen.y;
+    z = obj->gen.z;
+    list[0] = INDEX(x, y, z);
+    for(n = 1; x != obj->equ.x || y != obj->equ.y || z != obj->equ.z; ++ n) {
+      x += step[0];
+      y += step[1];
+      z += step[2];
+      list[n] = INDEX(x, y, z);
+      if((x != obj->equ.x || y != obj->equ.y || z != obj->equ.z)
+      && (_solver->object_no_list[list[n]] != -1 || cover[(x * scale + y) * scale + z] != 1)) {
+        break;
+      }
+    }
+    if(x != obj->equ.x || y != obj->equ.y || z != obj->equ.z) {
+      continue;
+    }
+    if(!IS_OPEN(_route_list + list[0]) || !IS_OPEN(_route_list + list[n - 1])) {
+      continue;
+    }
+    compact_link(_route_list, list, n);
+    for(j = 0; j < n; ++ j) {
+      _solver->frozen[list[j]] = FROZEN_PRESOLVE;
+    }
+  }
+  free(cover);
+  // 固定したペアと、固定した順路に端点を塞がれたペアはコストリストから外す
+  size = 0;
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    cost = _solver->cost_list + i;
+    obj = _solver->object_list + cost->key;
+    index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    if(_solver->frozen[index] || _solver->frozen[INDEX(obj->equ.x, obj->equ.y, obj->equ.z)]) {
+      continue;
+    }
+    _solver->cost_list[size] = *cost;
+    ++ size;
+  }
+  _solver->cost_size = size;
+  return 0;
+}
+
+//////////////////////////////
+// 順路の数を取得
+//////////////////////////////
+static int count_route(object_t const* const _object_list, route_t const* const _route_list) {
+  int i, count;
+  object_t const* obj;
+  route_t const* rt;
+
+  count = 0;
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    obj = _object_list + i;
+    rt = _route_list + INDEX(obj->gen.x, obj->gen.y, obj->gen.z);;
+    if(IS_HEAD(rt)) {
+      ++ count;
+    }
+  }
+  return count;
+}
+
+//////////////////////////////
+// 乱数seed設定
+//////////////////////////////
+static void initrand(rand_t* const _rand, uint32_t seed) {
+  do {
+      seed = seed*1812433253 + 1; seed ^= seed<<13; seed ^= seed>>17;
+      _rand->x = 123464980 ^ seed;
+      seed = seed*1812433253 + 1; seed ^= seed<<13; seed ^= seed>>17;
+      _rand->y = 3447902351 ^ seed;
+      seed = seed*1812433253 + 1; seed ^= seed<<13; seed ^= seed>>17;
+      _rand->z = 2859490775 ^ seed;
+      seed = seed*1812433253 + 1; seed ^= seed<<13; seed ^= seed>>17;
+      _rand->w = 47621719 ^ seed;
+  } while(_rand->x==0 && _rand->y==0 && _rand->z==0 && _rand->w==0);
+}
+
+//////////////////////////////
+// 0〜1未満の乱数生成
+//////////////////////////////
+static double urand(rand_t* const _rand) {
+  uint32_t t;
+  t = _rand->x ^ (_rand->x<<11);
+  _rand->x = _rand->y;
+  _rand->y = _rand->z;
+  _rand->z = _rand->w;
+  _rand->w ^= t ^ (t>>8) ^ (_rand->w>>19);
+  return ((_rand->x+0.5) / 4294967296.0 + _rand->w) / 4294967296.0;
+}
+
+//////////////////////////////
+// 経過時間計測用の時刻（秒）
+//////////////////////////////
+static double get_time() {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+//////////////////////////////
+// タブーリストの初期化
+//////////////////////////////
+static int init_tabu_list(vigne_solver_t* const _solver) {
+  int tabu_size;
+
+  free_tabu_list(_solver);
+  if(_solver->config.tabu_size <= 0) {
+    return 0;
+  }
+  // 2の冪に切り上げる
+  for(tabu_size = 1; tabu_size < _solver->config.tabu_size; tabu_size <<= 1);
+  if((_solver->tabu_list = (uint64_t*)calloc(tabu_size, sizeof(uint64_t))) == NULL) {
+    return -1;
+  }
+  _solver->tabu_size = tabu_size;
+  return 0;
+}
+
+//////////////////////////////
+// タブーリストの開放
+//////////////////////////////
+static void free_tabu_list(vigne_solver_t* const _solver) {
+  free(_solver->tabu_list);
+  _solver->tabu_list = NULL;
+  _solver->tabu_size = 0;
+}
+
+//////////////////////////////
+// ハッシュ値の攪拌（splitmix64）
+//////////////////////////////
+static uint64_t hash_mix(uint64_t _key) {
+  _key += 0x9e3779b97f4a7c15ull;
+  _key = (_key ^ (_key >> 30)) * 0xbf58476d1ce4e5b9ull;
+  _key = (_key ^ (_key >> 27)) * 0x94d049bb133111ebull;
+  return _key ^ (_key >> 31);
+}
+
+//////////////////////////////
+// 順路のハッシュ値（部屋→次の部屋のつながりごとの乱数のXOR）
+//////////////////////////////
+static uint64_t hash_route_list(route_t const* const _route_list) {
+  int i;
+  uint64_t hash;
+
+  hash = 0;
+  for(i = 0; i < VIGNE_CELL_SIZE; ++ i) {
+    if(_route_list[i].next != -1) {
+      hash ^= hash_mix(((uint64_t)i << 32) | (uint64_t)_route_list[i].next);
+    }
+  }
+  return hash;
+}
+
+//////////////////////////////
+// タブーリストのキー（親順路のハッシュ値とゾーンの組）
+// 固定した部屋が変わると同じゾーンでも削除する順路が変わるので、固定の世代も混ぜる
+//////////////////////////////
+static uint64_t tabu_key(vigne_solver_t const* const _solver, zone_t const* const _zone) {
+  uint64_t zone;
+
+  zone = (uint64_t)_zone->begin.x;
+  zone = (zone << 10) | (uint64_t)_zone->begin.y;
+  zone = (zone << 10) | (uint64_t)_zone->begin.z;
+  zone = (zone << 10) | (uint64_t)_zone->end.x;
+  zone = (zone << 10) | (uint64_t)_zone->end.y;
+  zone = (zone << 10) | (uint64_t)_zone->end.z;
+  return hash_mix(_solver->hash ^ hash_mix(zone ^ hash_mix(_solver->frozen_epoch))) | 1;
+}
+
+//////////////////////////////
+// タブーリストに含まれるか
+//////////////////////////////
+static int tabu_find(vigne_solver_t const* const _solver, uint64_t const _key) {
+  if(_solver->tabu_size == 0) {
+    return 0;
+  }
+  return _solver->tabu_list[_key & (uint64_t)(_solver->tabu_size - 1)] == _key;
+}
+
+//////////////////////////////
+// タブーリストに追加（同じ場所にあった古い組は上書きする）
+//////////////////////////////
+static void tabu_insert(vigne_solver_t* const _solver, uint64_t const _key) {
+  if(_solver->tabu_size == 0) {
+    return;
+  }
+  _solver->tabu_list[_key & (uint64_t)(_solver->tabu_size - 1)] = _key;
+}
+
+//////////////////////////////
+// 探索順の学習の初期化（優先度の平均はペアのコスト、つまり既定の探索順から始める）
+//////////////////////////////
+static int init_learn_list(vigne_solver_t* const _solver) {
+  int i, batch;
+
+  free_learn_list(_solver);
+  batch = _solver->config.learn_batch < LEARN_BATCH_MAX ? _solver->config.learn_batch : LEARN_BATCH_MAX;
+  if(batch <= 0) {
+    return 0;
+  }
+  _solver->learn_batch = batch;
+  _solver->learn_mean = (double*)malloc(sizeof(double) * OBJECT_SIZE);
+  _solver->learn_sigma = (double*)malloc(sizeof(double) * OBJECT_SIZE);
+  _solver->learn_sample = (float*)malloc(sizeof(float) * OBJECT_SIZE * batch);
+  _solver->learn_score = (int*)malloc(sizeof(int) * batch);
+  if(_solver->learn_mean == NULL || _solver->learn_sigma == NULL
+  || _solver->learn_sample == NULL || _solver->learn_score == NULL) {
+    free_learn_list(_solver);
+    return -1;
+  }
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    _solver->learn_mean[i] = (double)_solver->object_list[i].cost;
+    _solver->learn_sigma[i] = LEARN_SIGMA;
+  }
+  return 0;
+}
+
+//////////////////////////////
+// 探索順の学習の開放
+//////////////////////////////
+static void free_learn_list(vigne_solver_t* const _solver) {
+  free(_solver->learn_mean);
+  free(_solver->learn_sigma);
+  free(_solver->learn_sample);
+  free(_solver->learn_score);
+  _solver->learn_mean = NULL;
+  _solver->learn_sigma = NULL;
+  _solver->learn_sample = NULL;
+  _solver->learn_score = NULL;
+  _solver->learn_size = 0;
+  _solver->learn_batch = 0;
+}
+
+//////////////////////////////
+// ペアごとに優先度を分布から引き、優先度の高い順にコストリストを並べる
+// （子順路で両端が空いていて、これから探索するペアだけを引く）
+//////////////////////////////
+static void learn_sample(vigne_solver_t* const _solver) {
+  int i, key;
+  double noise, priority;
+  float* sample;
+  object_t const* obj;
+
+  sample = _solver->learn_sample + (size_t)_solver->learn_size * OBJECT_SIZE;
+  for(i = 0; i < _solver->cost_size; ++ i) {
+    key = _solver->cost_list[i].key;
+    obj = _solver->object_list + key;
+    if(!IS_OPEN(_solver->route_child + INDEX(obj->gen.x, obj->gen.y, obj->gen.z))
+    || !IS_OPEN(_solver->route_child + INDEX(obj->equ.x, obj->equ.y, obj->equ.z))) {
+      sample[key] = LEARN_NONE;
+      _solver->cost_list[i].value = (int)(_solver->learn_mean[key] * LEARN_SCALE);
+      continue;
+    }
+    // 一様乱数4つの和で正規分布を近似する（平均0、分散1）
+    noise = (urand(&_solver->rand) + urand(&_solver->rand) + urand(&_solver->rand) + urand(&_solver->rand) - 2.0)
+          * 1.7320508;
+    priority = _solver->learn_mean[key] + _solver->learn_sigma[key] * noise;
+    sample[key] = (float)priority;
+    _solver->cost_list[i].value = (int)(priority * LEARN_SCALE);
+  }
+  qsort(_solver->cost_list, _solver->cost_size, sizeof(qsort_t), qsort_desc);
+}
+
+//////////////////////////////
+// 引いた探索順の順路数を記録し、バッチがそろったら分布を更新する
+//////////////////////////////
+static void learn_record(vigne_solver_t* const _solver, int const _total) {
+  _solver->learn_score[_solver->learn_size] = _total;
+  ++ _solver->learn_size;
+  if(_solver->learn_size == _solver->learn_batch) {
+    learn_update(_solver);
+    _solver->learn_size = 0;
+  }
+}
+
+//////////////////////////////
+// 順路数が上位の標本の優先度に、分布の平均とばらつきを近づける（クロスエントロピー法）
+//////////////////////////////
+static void learn_update(vigne_solver_t* const _solver) {
+  int i, j, k, n, key, batch, elite_size, tmp;
+  int order[LEARN_ELITE_MAX];
+  double mean, spread;
+  float const* sample;
+
+  batch = _solver->learn_batch;
+  elite_size = batch / LEARN_ELITE_RATE;
+  if(elite_size < 1) {
+    elite_size = 1;
+  }
+  if(elite_size > LEARN_ELITE_MAX) {
+    elite_size = LEARN_ELITE_MAX;
+  }
+  // 順路数の多い標本を選ぶ（挿入ソート、同じ順路数なら後の標本を優先する）
+  k = 0;
+  for(i = batch - 1; i >= 0; -- i) {
+    if(k < elite_size) {
+      order[k] = i;
+      ++ k;
+    } else if(_solver->learn_score[i] > _solver->learn_score[order[k - 1]]) {
+      order[k - 1] = i;
+    } else {
+      continue;
+    }
+    for(j = k - 1; j > 0 && _solver->learn_score[order[j]] > _solver->learn_score[order[j - 1]]; -- j) {
+      tmp = order[j];
+      order[j] = order[j - 1];
+      order[j - 1] = tmp;
+    }
+  }
+  // ペアごとに、探索した標本だけで平均と平均偏差を求めて、少しずつ近づける
+  // （平均偏差は正規分布の標準偏差の約0.8倍）
+  for(i = 0; i < _solver->cost_size; ++ i) {
+    key = _solver->cost_list[i].key;
+    n = 0;
+    mean = 0.0;
+    for(j = 0; j < elite_size; ++ j) {
+      sample = _solver->learn_sample + (size_t)order[j] * OBJECT_SIZE;
+      if(sample[key] != LEARN_NONE) {
+        mean += sample[key];
+        ++ n;
+      }
+    }
+    if(n == 0) {
+      continue;
+    }
+    mean /= (double)n;
+    spread = 0.0;
+    for(j = 0; j < elite_size; ++ j) {
+      sample = _solver->learn_sample + (size_t)order[j] * OBJECT_SIZE;
+      if(sample[key] != LEARN_NONE) {
+        spread += sample[key] > mean ? sample[key] - mean : mean - sample[key];
+      }
+    }
+    spread = spread / (double)n * 1.25;
+    _solver->learn_mean[key] += LEARN_SMOOTH * (mean - _solver->learn_mean[key]);
+    _solver->learn_sigma[key] += LEARN_SMOOTH * (spread - _solver->learn_sigma[key]);
+    // ばらつきを残して探索を続ける
+    if(_solver->learn_sigma[key] < LEARN_SIGMA_MIN) {
+      _solver->learn_sigma[key] = LEARN_SIGMA_MIN;
+    }
+  }
+}
+
+//////////////////////////////
+// 骨格の統計の初期化
+//////////////////////////////
+static int init_backbone_list(vigne_solver_t* const _solver) {
+  free_backbone_list(_solver);
+  if(_solver->config.backbone_accept <= 0) {
+    return 0;
+  }
+  _solver->stable_count = (int*)calloc(OBJECT_SIZE, sizeof(int));
+  _solver->stable_hash = (uint64_t*)calloc(OBJECT_SIZE, sizeof(uint64_t));
+  if(_solver->stable_count == NULL || _solver->stable_hash == NULL) {
+    free_backbone_list(_solver);
+    return -1;
+  }
+  return 0;
+}
+
+//////////////////////////////
+// 骨格の統計の開放
+//////////////////////////////
+static void free_backbone_list(vigne_solver_t* const _solver) {
+  free(_solver->stable_count);
+  free(_solver->stable_hash);
+  _solver->stable_count = NULL;
+  _solver->stable_hash = NULL;
+  _solver->backbone_size = 0;
+}
+
+//////////////////////////////
+// 親順路の更新ごとに、順路が変わらないペアを数えて骨格として固定する
+//////////////////////////////
+static void backbone_update(vigne_solver_t* const _solver) {
+  int i, index;
+  uint64_t hash;
+  object_t const* obj;
+  route_t const* route_list;
+
+  if(_solver->stable_count == NULL) {
+    return;
+  }
+  route_list = _solver->route_parent;
+  for(i = 0; i < OBJECT_SIZE; ++ i) {
+    obj = _solver->object_list + i;
+    index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+    // 固定済みのペアは数えない
+    if(_solver->frozen[index]) {
+      continue;
+    }
+    // 順路のハッシュ値（順路が無ければ 0）
+    hash = 0;
+    if(IS_HEAD(route_list + index)) {
+      for(; index != -1; index = route_list[index].next) {
+        hash ^= hash_mix((uint64_t)index);
+      }
+    }
+    if(hash != 0 && hash == _solver->stable_hash[i]) {
+      ++ _solver->stable_count[i];
+    } else {
+      _solver->stable_count[i] = 0;
+      _solver->stable_hash[i] = hash;
+    }
+    // 一定回数変わらなければ固定する
+    if(_solver->stable_count[i] >= _solver->config.backbone_accept) {
+      index = INDEX(obj->gen.x, obj->gen.y, obj->gen.z);
+      for(; index != -1; index = route_list[index].next) {
+        _solver->frozen[index] = FROZEN_BACKBONE;
+      }
+      ++ _solver->backbone_size;
+      ++ _solver->frozen_epoch;
+    }
+  }
+}
+
+//////////////////////////////
+// 骨格の固定を外す（前処理で固定した順路はそのまま）
+//////////////////////////////
+static void backbone_release(vigne_solver_t* const _solver) {
+  int i;
+
+  if(_solver->backbone_size == 0) {
+    return;
+  }
+  for(i = 0; i < VIGNE_CELL_SIZE; ++ i) {
+    if(_solver->frozen[i] == FROZEN_BACKBONE) {
+      _solver->frozen[i] = 0;
+    }
+  }
+  memset(_solver->stable_count, 0, sizeof(int) * OBJECT_SIZE);
+  _solver->backbone_size = 0;
+  ++ _solver->frozen_epoch;
+}
+
+//////////////////////////////
+// Zoning Sample（削除するゾーンを選ぶ）
+//////////////////////////////
+static void zoning_sample(rand_t* const _rand, zone_t* const _zone) {
+  int begin_x, end_x, width_x;
+  int begin_y, end_y, width_y;
+  int begin_z, end_z, width_z;
+
+  // X座標の幅と位置を決める
+  width_x = (int)(urand(_rand) * (double)(ZX_WIDTH_MAX - ZX_WIDTH_MIN)) + ZX_WIDTH_MIN;
+  begin_x = (int)(urand(_rand) * (double)(SCALE_SIZE - width_x));
+  end_x = begin_x + width_x;
+  // Y座標の幅と位置を決める
+  width_y = (int)(urand(_rand) * (double)(ZX_WIDTH_MAX - ZX_WIDTH_MIN)) + ZX_WIDTH_MIN;
+  begin_y = (int)(urand(_rand) * (double)(SCALE_SIZE - width_y));
+  end_y = begin_y + width_y;
+  // Z座標の幅と位置を決める
+  width_z = (int)(urand(_rand) * (double)(ZX_WIDTH_MAX - ZX_WIDTH_MIN)) + ZX_WIDTH_MIN;
+  begin_z = (int)(urand(_rand) * (double)(SCALE_SIZE - width_z));
+  end_z = begin_z + width_z;
+  _zone->begin.x = begin_x;
+  _zone->begin.y = begin_y;
+  _zone->begin.z = begin_z;
+  _zone->end.x = end_x;
+  _zone->end.y = end_y;
+  _zone->end.z = end_z;
+}
+
+//////////////////////////////
+// Zoning Remove（ゾーン内に接している順路を削除）
+//////////////////////////////
+static void zoning_remove(route_t const* const _route_parent, route_t* const _route_child,
+                          unsigned char const* const _frozen, zone_t const* const _zone) {
+  int x, y, z;
+  int copy_size, route_index;
+
+  // 親順路から子順路にコピー
+  copy_size = sizeof(route_t) * VIGNE_CELL_SIZE;
+  memcpy(_route_child, _route_parent, copy_size);
+  // 順路削除
+  for(x = _zone->begin.x; x <= _zone->end.x; ++ x) {
+    for(y = _zone->begin.y; y <= _zone->end.y; ++ y) {
+      for(z = _zone->begin.z; z <= _zone->end.z; ++ z) {
+        route_index = INDEX(x, y, z);
+        // ゾーン内に接している順路を削除
+        zx_remove_route(route_index, _route_child, _frozen);
+      }
+    }
+  }
+}
+
+//////////////////////////////
+// Zoning Crossover (ZX)
+//////////////////////////////
+// void zx_crossover(object_t const* const _object_list, int const* const _object_no_list, qsort_t const* const _cost_list,
+//                   route_t const* const _route_parent_1, route_t const* const _route_parent_2,
+//                   route_t* const _route_child_1, route_t* const _route_child_2) {
+//   int begin_x, end_x, width_x;
+//   int begin_y, end_y, width_y;
+//   int begin_z, end_z, width_z;
+//   int x, y, z;
+//   int copy_size, route_index;
+
+//   // X座標の幅と位置を決める
+//   width_x = (int)(urand() * (double)(ZX_WIDTH_MAX - ZX_WIDTH_MIN)) + ZX_WIDTH_MIN;
+//   begin_x = (int)(urand() * (double)(SCALE_SIZE - width_x));
+//   end_x = begin_x + width_x;
+//   // Y座標の幅と位置を決める
+//   width_y = (int)(urand() * (double)(ZX_WIDTH_MAX - ZX_WIDTH_MIN)) + ZX_WIDTH_MIN;
+//   begin_y = (int)(urand() * (double)(SCALE_SIZE - width_y));
+//   end_y = begin_y + width_y;
+//   // Z座標の幅と位置を決める
+//   width_z = (int)(urand() * (double)(ZX_WIDTH_MAX - ZX_WIDTH_MIN)) + ZX_WIDTH_MIN;
+//   begin_z = (int)(urand() * (double)(SCALE_SIZE - width_z));
+//   end_z = begin_z + width_z;
+//   // 親順路から子順路にコピー
+//   copy_size = sizeof(route_t) * VIGNE_CELL_SIZE;
+//   memcpy(_route_child_1, _route_parent_1, copy_size);
+//   memcpy(_route_child_2, _route_parent_2, copy_size);
+
+//   for(x = begin_x; x <= end_x; ++ x) {
+//     for(y = begin_y; y <= end_y; ++ y) {
+//       for(z = begin_z; z <= end_z; ++ z) {
+//         route_index = INDEX(x, y, z);
+//         // ゾーン内に接している順路を削除
+//         zx_remove_route(route_index, _route_child_1);
+//         zx_remove_route(route_index, _route_child_2);
+//       }
+//     }
+//   }
+// }
+
+//////////////////////////////
+// ゾーンの内側にルートがあるかどうか判定
+//////////////////////////////
+static int zx_inner_zone(int const _begin_x, int const _end_x,
+                         int const _begin_y, int const _end_y,
+                         int const _begin_z, int const _end_z,
+                         int const _route_index, route_t const* const _route_list) {
+  int index;
+  route_t const* rt;
+
+  // NEXT チェック
+  index = _route_index;
+  while(index != -1) {
+    rt = _route_list + index;
+    // はみ出しチェック
+    if(rt->coord.x < _begin_x || _end_x < rt->coord.x
+    || rt->coord.y < _begin_y || _end_y < rt->coord.y
+    || rt->coord.z < _begin_z || _end_z < rt->coord.z) {
+      return 0;
+    }
+    index = rt->next;
+  }
+  // PREV チェック
+  index = _route_index;
+  while(index != -1) {
+    rt = _route_list + index;
+    // はみ出しチェック
+    if(rt->coord.x < _begin_x || _end_x < rt->coord.x
+    || rt->coord.y < _begin_y || _end_y < rt->coord.y
+    || rt->coord.z < _begin_z || _end_z < rt->coord.z) {
+      return 0;
+    }
+    index = rt->prev;
+  }
+  return 1;
+}
+
+//////////////////////////////
+// 指定された順路を削除する
+//////////////////////////////
+static void zx_remove_route(int const _route_index, route_t* const _route_list,
+                            unsigned char const* const _frozen) {
+  int index;
+  route_t* rt;
+
+  // 固定した順路は削除しない
+  if(_frozen != NULL && _frozen[_route_index]) {
+    return;
+  }
+  // NEXT 削除
+  rt = _route_list + _route_index;
+  index = rt->next;
+  rt->next = -1;
+  while(index != -1) {
+    rt = _route_list + index;
+    index = rt->next;
+    rt->prev = -1;
+    rt->next = -1;
+  }
+  // PREV 削除
+  rt = _route_list + _route_index;
+  index = rt->prev;
+  rt->prev = -1;
+  while(index != -1) {
+    rt = _route_list + index;
+    index = rt->prev;
+    rt->prev = -1;
+    rt->next = -1;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#ifndef VIGNE_H
+#define VIGNE_H
+
+//////////////////////////////
+// マクロ・定数
+//////////////////////////////
+#ifndef VIGNE_OBJECT_SIZE
+#define VIGNE_OBJECT_SIZE 4000
+#endif
+#ifndef VIGNE_SCALE_SIZE
+#define VIGNE_SCALE_SIZE 20
+#endif
+// セルの並び（0: X,Y,Z順、1: 4x4x4部屋のブロック順、2: モートン順（Zオーダー））
+#ifndef VIGNE_CELL_LAYOUT
+#define VIGNE_CELL_LAYOUT 0
+#endif
+#define VIGNE_CELL_BLOCK_BITS 2
+#define VIGNE_CELL_BLOCK (1 << VIGNE_CELL_BLOCK_BITS)
+#if VIGNE_CELL_LAYOUT == 1
+// 一辺をブロックの倍数に切り上げる
+#define VIGNE_SCALE_ALIGN ((VIGNE_SCALE_SIZE + VIGNE_CELL_BLOCK - 1) / VIGNE_CELL_BLOCK * VIGNE_CELL_BLOCK)
+#elif VIGNE_CELL_LAYOUT == 2
+// 一辺を2の冪に切り上げる（1辺1024部屋まで）
+#define VIGNE_SCALE_ALIGN (VIGNE_SCALE_SIZE <= 1 ? 1 : VIGNE_SCALE_SIZE <= 2 ? 2 : VIGNE_SCALE_SIZE <= 4 ? 4 \
+                         : VIGNE_SCALE_SIZE <= 8 ? 8 : VIGNE_SCALE_SIZE <= 16 ? 16 : VIGNE_SCALE_SIZE <= 32 ? 32 \
+                         : VIGNE_SCALE_SIZE <= 64 ? 64 : VIGNE_SCALE_SIZE <= 128 ? 128 : VIGNE_SCALE_SIZE <= 256 ? 256 \
+                         : VIGNE_SCALE_SIZE <= 512 ? 512 : 1024)
+#else
+#define VIGNE_SCALE_ALIGN VIGNE_SCALE_SIZE
+#endif
+// セル配列の要素数（切り上げではみ出したセルは座標が -1 で、順路には使われない）
+#define VIGNE_CELL_SIZE (VIGNE_SCALE_ALIGN * VIGNE_SCALE_ALIGN * VIGNE_SCALE_ALIGN)
+// 探索順の学習で分布を更新する世代間隔の上限（標本を VIGNE_OBJECT_SIZE 個の float でこの数だけ保持する）
+#define VIGNE_LEARN_BATCH_MAX 256
+
+//////////////////////////////
+// 型定義
+//////////////////////////////
+
+typedef struct {
+  int x; // X座標
+  int y; // Y座標
+  int z; // Z座標
+} vigne_xyz_t;
+
+typedef struct {
+  int prev;          // 前のINDEX（無ければ -1）
+  int next;          // 次のINDEX（無ければ -1）
+  vigne_xyz_t coord; // 座標
+} vigne_cell_t;
+
+typedef struct vigne_solver vigne_solver_t;
+
+typedef struct {
+  unsigned int seed; // 乱数seed
+  int stagnation;    // 改善が無いまま続いたら探索を打ち切る世代数
+  int tile_size;     // 階層探索のタイルの一辺（部屋数、0なら部屋単位で全体を探索する）
+  int threads;       // 初期順路構築のスレッド数（1以下なら並列化しない、階層探索とは併用しない）
+  int region_size;   // 並列構築で独立に探索する領域の一辺（部屋数）
+  int speculate_window; // 並列構築で先読みするペアの数（0なら領域ごとに構築する、結果は逐次構築と同じ）
+  int compact_interval; // 順路を詰め直す世代間隔（0なら詰め直さない）
+  int eject_budget;  // 1世代で押しのけ連鎖を試すペアの数（0なら試さない）
+  double gap_limit;  // 上界との差が上界のこの割合以下になったら探索を打ち切る（0なら上界に達したときだけ）
+  int elite_size;    // 保持するエリート解の数（0なら保持しない）
+  int relink_interval; // エリート解に向かうパスリリンキングの世代間隔（0なら行わない）
+  int presolve;      // つなぐしかないペアを最初に固定するか（0なら固定しない）
+  int tabu_size;     // 改善しなかった（順路, ゾーン）の組を覚えておく数（0なら覚えない）
+  int backbone_accept;  // 順路が変わらないまま親順路がこの回数更新されたペアは固定する（0なら固定しない）
+  int backbone_release; // 改善が無いままこの世代数続いたら固定を外す
+  int exact_nodes;   // ゾーン内のつなぎ方を厳密に探すときのノード数の上限（0なら探さない）
+  int connect_candidates; // 再構築で残す候補経路の数（2以上なら、まだつながっていないペアを閉じ込めない経路を選ぶ）
+  int conflict_length; // 並列構築で、距離がこれ以下のペアから互いに探索範囲が重ならないものを先に探索する（最初の構築だけで使う、0なら行わない、threads が1以下なら使わない）
+  int learn_batch;   // 探索順を学習するときに分布を更新する世代間隔（0なら学習せず、コスト順にする、VIGNE_LEARN_BATCH_MAX まで）
+  // 順路数が更新されたときに呼ばれる（NULLなら呼ばない）
+  void (*on_update)(void* _user, vigne_solver_t const* _solver, int _total, int _stale);
+  void* user;        // on_update に渡すポインタ
+} vigne_config_t;
+
+//////////////////////////////
+// プロトタイプ宣言
+//////////////////////////////
+
+// 設定を既定値で初期化
+void vigne_config_init(vigne_config_t* const _config);
+
+// 座標配列（x, y, z を VIGNE_OBJECT_SIZE 組並べたもの）から生成し、初期順路を構築する
+// 座標が範囲外・重複・個数不一致なら NULL
+vigne_solver_t* vigne_create(int const* const _gen_xyz, int const* const _equ_xyz, int const _size,
+                             vigne_config_t const* const _config);
+// 領域を使い回して別のインスタンスを読み込み、初期順路を構築する（_config が NULL なら設定はそのまま）
+int vigne_load(vigne_solver_t* const _solver,
+               int const* const _gen_xyz, int const* const _equ_xyz, int const _size,
+               vigne_config_t const* const _config);
+void vigne_destroy(vigne_solver_t* const _solver);
+
+// 1世代（ゾーン削除→順路再構築）進める、更新したら 1、しなければ 0
+int vigne_step(vigne_solver_t* const _solver);
+// 制限時間（秒）か世代数（0以下ならそれぞれ無制限）か停滞で止まるまで進め、順路数を返す
+int vigne_run(vigne_solver_t* const _solver, double const _time_limit, long const _generation);
+
+// 現在の順路数
+int vigne_score(vigne_solver_t const* const _solver);
+// 順路数の上界（読み込み時に求め、世代を進めるごとに絞り込む）
+int vigne_bound(vigne_solver_t const* const _solver);
+// これまでに実行した世代数
+long vigne_generation(vigne_solver_t const* const _solver);
+
+// 座標からセルのINDEXを求める（座標が [0, VIGNE_SCALE_SIZE) の外なら -1、vigne_object_no は -1 を「無し」として扱う）
+int vigne_index(int const _x, int const _y, int const _z);
+// 内部の順路グリッド（VIGNE_CELL_SIZE 個、コピーせずにそのまま参照する、並びは VIGNE_CELL_LAYOUT による）
+// 親順路を指しているので、vigne_step・vigne_run・vigne_load を呼ぶと別の（作業中の）グリッドを指すことがある
+// ポインタはそれらを次に呼ぶまでしか使えず、呼んだ後は取り直す
+vigne_cell_t const* vigne_grid(vigne_solver_t const* const _solver);
+// オブジェクトNo.の順路の先頭INDEX（順路が無ければ -1）、以降は grid[index].next を辿る
+int vigne_route_head(vigne_solver_t const* const _solver, int const _object_no);
+// セルに置かれたオブジェクトNo.（無ければ -1）
+int vigne_object_no(vigne_solver_t const* const _solver, int const _index);
+
+#endif